@@ -0,0 +1,205 @@
+#ifndef GGJ2015_ASSETARCHIVE
+#define GGJ2015_ASSETARCHIVE
+
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+#if !defined(_WIN32)
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+#include "../GGJ2015/Common.hpp"
+
+namespace ggj
+{
+	/// @brief Layout of the packed asset archive written by `ggj_cook`:
+	/// a `Header`, a fixed table of `Entry` sorted by id, then the blobs, each aligned to `blobAlign`.
+	/// Blobs are stored ready for upload, so loading them involves no decoding:
+	/// - `Texture`: RGBA8 pixels, `a` x `b`.
+	/// - `SoundBuffer`: interleaved 16-bit samples, `a` channels at `b` Hz.
+	/// - `Font`: `BitmapFontData` as four `uint32`, followed by the id of the font's texture entry.
+	/// - `Music`: the encoded file as-is, streamed from the mapping while it plays.
+	/// Entries with an empty group are loaded at startup; the others belong to a manifest group.
+	namespace Archive
+	{
+		constexpr std::uint32_t magic{0x414a4747};		// "GGJA"
+		constexpr std::uint32_t version{2};
+		constexpr SizeT idLength{48};
+		constexpr SizeT groupLength{16};
+		constexpr SizeT blobAlign{16};
+		constexpr const char* fileName{"assets.pak"};
+
+		enum class Kind : std::uint32_t {Texture = 0, SoundBuffer = 1, Font = 2, Music = 3};
+
+		struct Header
+		{
+			std::uint32_t magic, version, entryCount, reserved;
+		};
+
+		struct Entry
+		{
+			char id[idLength];
+			char group[groupLength];
+			Kind kind;
+			std::uint32_t a, b, reserved;
+			std::uint64_t offset, size;
+		};
+
+		static_assert(std::is_trivially_copyable<Header>{} && sizeof(Header) == 16, "Header is stored as-is");
+		static_assert(std::is_trivially_copyable<Entry>{} && sizeof(Entry) == 96, "Entry is stored as-is");
+
+		inline bool operator<(const Entry& mA, const Entry& mB) noexcept { return std::strncmp(mA.id, mB.id, idLength) < 0; }
+	}
+
+	/// @brief Read-only view of a whole file. Uses `mmap` where available, so pages are only read
+	/// when touched; elsewhere the file is read into memory in one call.
+	class MappedFile
+	{
+		private:
+			const char* data{nullptr};
+			SizeT size{0};
+#if defined(_WIN32)
+			std::vector<char> buffer;
+#endif
+
+		public:
+			inline MappedFile() = default;
+			inline ~MappedFile() { close(); }
+
+			inline MappedFile(const MappedFile&) = delete;
+			inline MappedFile& operator=(const MappedFile&) = delete;
+
+			inline bool open(const std::string& mPath)
+			{
+				close();
+
+#if defined(_WIN32)
+				std::ifstream f{mPath, std::ios::binary | std::ios::ate};
+				if(!f) return false;
+
+				buffer.resize(static_cast<SizeT>(f.tellg()));
+				f.seekg(0);
+				if(!f.read(buffer.data(), buffer.size())) { buffer.clear(); return false; }
+
+				data = buffer.data();
+				size = buffer.size();
+#else
+				auto fd(::open(mPath.c_str(), O_RDONLY));
+				if(fd < 0) return false;
+
+				struct stat st;
+				if(::fstat(fd, &st) != 0 || st.st_size == 0) { ::close(fd); return false; }
+
+				auto* mapping(::mmap(nullptr, static_cast<SizeT>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0));
+				::close(fd);
+				if(mapping == MAP_FAILED) return false;
+
+				data = static_cast<const char*>(mapping);
+				size = static_cast<SizeT>(st.st_size);
+#endif
+				return true;
+			}
+
+			inline void close() noexcept
+			{
+				if(data == nullptr) return;
+
+#if defined(_WIN32)
+				buffer.clear();
+#else
+				::munmap(const_cast<char*>(data), size);
+#endif
+				data = nullptr;
+				size = 0;
+			}
+
+			inline const char* getData() const noexcept { return data; }
+			inline SizeT getSize() const noexcept { return size; }
+	};
+
+	/// @brief A mapped asset archive. `open` validates the header and the index table;
+	/// blob contents are not touched until an asset is loaded.
+	class AssetArchive
+	{
+		private:
+			MappedFile file;
+			const Archive::Entry* entries{nullptr};
+			SizeT entryCount{0};
+
+		public:
+			inline bool open(const std::string& mPath)
+			{
+				entries = nullptr;
+				entryCount = 0;
+
+				if(!file.open(mPath)) return false;
+
+				const auto* data(file.getData());
+				auto size(file.getSize());
+				Archive::Header header;
+
+				if(size < sizeof(header)) return false;
+				std::memcpy(&header, data, sizeof(header));
+				if(header.magic != Archive::magic || header.version != Archive::version) return false;
+				if((size - sizeof(header)) / sizeof(Archive::Entry) < header.entryCount) return false;
+
+				const auto* table(reinterpret_cast<const Archive::Entry*>(data + sizeof(header)));
+				for(auto i(0u); i < header.entryCount; ++i)
+					if(table[i].offset > size || table[i].size > size - table[i].offset) return false;
+
+				entries = table;
+				entryCount = header.entryCount;
+				return true;
+			}
+
+			inline bool isOpen() const noexcept { return entries != nullptr; }
+
+			inline const Archive::Entry* begin() const noexcept { return entries; }
+			inline const Archive::Entry* end() const noexcept { return entries + entryCount; }
+
+			inline const Archive::Entry* find(const std::string& mID) const
+			{
+				Archive::Entry key;
+				std::strncpy(key.id, mID.c_str(), Archive::idLength);
+
+				auto itr(std::lower_bound(begin(), end(), key));
+				return itr != end() && !(key < *itr) ? itr : nullptr;
+			}
+
+			inline const void* getData(const Archive::Entry& mX) const noexcept { return file.getData() + mX.offset; }
+
+			inline void load(sf::Texture& mTexture, const Archive::Entry& mX) const
+			{
+				SSVU_ASSERT(mX.kind == Archive::Kind::Texture);
+
+				mTexture.create(mX.a, mX.b);
+				mTexture.update(static_cast<const sf::Uint8*>(getData(mX)));
+			}
+
+			inline void load(sf::SoundBuffer& mSoundBuffer, const Archive::Entry& mX) const
+			{
+				SSVU_ASSERT(mX.kind == Archive::Kind::SoundBuffer);
+
+				mSoundBuffer.loadFromSamples(static_cast<const sf::Int16*>(getData(mX)), mX.size / sizeof(sf::Int16), mX.a, mX.b);
+			}
+
+			inline auto getFontData(const Archive::Entry& mX) const
+			{
+				SSVU_ASSERT(mX.kind == Archive::Kind::Font && mX.size > sizeof(std::uint32_t) * 4);
+
+				std::uint32_t fields[4];
+				std::memcpy(fields, getData(mX), sizeof(fields));
+				return ssvs::BitmapFontData{fields[0], fields[1], fields[2], fields[3]};
+			}
+
+			inline std::string getFontTextureID(const Archive::Entry& mX) const
+			{
+				const auto* str(static_cast<const char*>(getData(mX)) + sizeof(std::uint32_t) * 4);
+				return {str, strnlen(str, mX.size - sizeof(std::uint32_t) * 4)};
+			}
+	};
+}
+
+#endif
@@ -0,0 +1,310 @@
+#ifndef GGJ2015_ASSETLOADER
+#define GGJ2015_ASSETLOADER
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <chrono>
+#include "../GGJ2015/Common.hpp"
+#include "../GGJ2015/AssetArchive.hpp"
+#include "../GGJ2015/MusicStreamer.hpp"
+
+namespace ggj
+{
+	/// @brief Reference to an asset that may still be loading. Handles stay valid for the lifetime
+	/// of their loader and resolve as soon as the asset is published.
+	template<typename T> class AssetHandle
+	{
+		private:
+			const UPtr<T>* slot{nullptr};
+
+		public:
+			inline AssetHandle() = default;
+			inline AssetHandle(const UPtr<T>& mSlot) noexcept : slot{&mSlot} { }
+
+			inline bool isLoaded() const noexcept { return slot != nullptr && *slot != nullptr; }
+			inline T* get() const noexcept { return slot == nullptr ? nullptr : slot->get(); }
+
+			inline T& operator*() const noexcept { SSVU_ASSERT(isLoaded()); return **slot; }
+			inline T* operator->() const noexcept { SSVU_ASSERT(isLoaded()); return slot->get(); }
+	};
+
+	/// @brief Loads the asset groups declared in a manifest's "groups" object. `update` publishes
+	/// loaded assets on the calling thread, which must own the GL context because textures are
+	/// uploaded there. If the root path holds a cooked archive (see `AssetArchive.hpp`), it is
+	/// mapped and assets are uploaded straight from it. Otherwise `assets.json` is parsed, loose
+	/// files are decoded on a pool of worker threads, and everything outside the groups (bitmap
+	/// fonts and their textures) is loaded synchronously through `ssvs::loadAssetsFromJson`.
+	class AsyncAssetLoader
+	{
+		public:
+			using Clock = std::chrono::high_resolution_clock;
+
+		private:
+			enum class Kind : int {Texture = 0, SoundBuffer = 1};
+
+			struct Job
+			{
+				Kind kind;
+				std::string group, id, path;
+			};
+
+			struct Result
+			{
+				Kind kind;
+				std::string group, id;
+				sf::Image image;
+				UPtr<sf::SoundBuffer> soundBuffer;
+				const Archive::Entry* entry;		// Set when loading from the archive
+			};
+
+			Clock::time_point startTime{Clock::now()};
+			bool firstFrameReported{false};
+
+			std::map<std::string, UPtr<sf::Texture>> textures;
+			std::map<std::string, UPtr<sf::SoundBuffer>> soundBuffers;
+			std::map<std::string, UPtr<ssvs::BitmapFont>> fonts;		// Archive fonts only
+			AssetArchive archive;
+			std::string rootPath;
+			std::map<std::string, SizeT> pending;		// Assets not yet published, per group
+			std::map<std::string, std::vector<std::function<void()>>> onResident;
+
+			std::deque<Job> jobs;
+			std::vector<Result> results;
+			std::mutex mutex;
+			std::condition_variable cvJobs, cvResults;
+			std::vector<std::thread> workers;
+			bool stopping{false};
+
+			inline auto& getStorage(sf::Texture*) noexcept { return textures; }
+			inline auto& getStorage(sf::SoundBuffer*) noexcept { return soundBuffers; }
+
+			inline void work()
+			{
+				while(true)
+				{
+					Job job;
+
+					{
+						std::unique_lock<std::mutex> lock{mutex};
+						cvJobs.wait(lock, [this]{ return stopping || !jobs.empty(); });
+						if(jobs.empty()) return;
+
+						job = std::move(jobs.front());
+						jobs.pop_front();
+					}
+
+					Result result{job.kind, job.group, job.id, {}, nullptr, nullptr};
+
+					// Failures are logged by SFML; the asset is then published empty
+					if(job.kind == Kind::Texture) result.image.loadFromFile(job.path);
+					else
+					{
+						result.soundBuffer = ssvu::makeUPtr<sf::SoundBuffer>();
+						result.soundBuffer->loadFromFile(job.path);
+					}
+
+					{
+						std::lock_guard<std::mutex> lock{mutex};
+						results.emplace_back(std::move(result));
+					}
+
+					cvResults.notify_all();
+				}
+			}
+
+			inline void enqueue(Kind mKind, const std::string& mGroup, const std::string& mRootPath, const std::string& mID)
+			{
+				if(mKind == Kind::Texture) textures[mID];
+				else soundBuffers[mID];
+
+				++pending[mGroup];
+				jobs.emplace_back(Job{mKind, mGroup, mID, mRootPath + mID});
+			}
+
+			inline void publish(Result& mX)
+			{
+				if(mX.entry != nullptr)
+				{
+					if(mX.kind == Kind::Texture) archive.load(*(textures[mX.id] = ssvu::makeUPtr<sf::Texture>()), *mX.entry);
+					else archive.load(*(soundBuffers[mX.id] = ssvu::makeUPtr<sf::SoundBuffer>()), *mX.entry);
+				}
+				else if(mX.kind == Kind::Texture)
+				{
+					auto texture(ssvu::makeUPtr<sf::Texture>());
+					texture->loadFromImage(mX.image);
+					textures[mX.id] = std::move(texture);
+				}
+				else
+				{
+					soundBuffers[mX.id] = std::move(mX.soundBuffer);
+				}
+
+				// Startup assets (archive font textures) belong to no group
+				if(mX.group.empty() || --pending[mX.group] > 0) return;
+
+				ssvu::lo("Assets") << "Group `" << mX.group << "` resident after " << getElapsedMs() << "ms\n";
+				for(auto& f : onResident[mX.group]) f();
+				onResident[mX.group].clear();
+			}
+
+			// Font textures and fonts are loaded immediately. Group assets are queued as ready
+			// results, so that `update` publishes them without involving the workers.
+			inline void loadFromArchive()
+			{
+				for(const auto& e : archive)
+				{
+					if(e.kind == Archive::Kind::Font || e.kind == Archive::Kind::Music) continue;
+
+					auto kind(e.kind == Archive::Kind::Texture ? Kind::Texture : Kind::SoundBuffer);
+					Result result{kind, {e.group, strnlen(e.group, Archive::groupLength)}, {e.id, strnlen(e.id, Archive::idLength)}, {}, nullptr, &e};
+
+					if(result.group.empty()) { publish(result); continue; }
+
+					if(kind == Kind::Texture) textures[result.id];
+					else soundBuffers[result.id];
+
+					++pending[result.group];
+					results.emplace_back(std::move(result));
+				}
+
+				for(const auto& e : archive)
+				{
+					if(e.kind != Archive::Kind::Font) continue;
+
+					const auto& texture(*textures.at(archive.getFontTextureID(e)));
+					fonts[{e.id, strnlen(e.id, Archive::idLength)}] = ssvu::makeUPtr<ssvs::BitmapFont>(texture, archive.getFontData(e));
+				}
+			}
+
+		public:
+			ssvs::AssetManager assetManager;
+
+			inline AsyncAssetLoader(const std::string& mRootPath, SizeT mWorkers = std::thread::hardware_concurrency()) : rootPath{mRootPath}
+			{
+				if(archive.open(mRootPath + Archive::fileName)) { loadFromArchive(); return; }
+
+				auto manifest(ssvj::Val::fromFile(mRootPath + "assets.json"));
+				ssvs::loadAssetsFromJson(assetManager, mRootPath, manifest);
+
+				for(const auto& g : manifest["groups"].forObj())
+				{
+					const auto& group(g.key);
+					pending[group] = 0;
+
+					if(g.value.has("textures"))
+						for(const auto& id : g.value["textures"].forArrAs<std::string>()) enqueue(Kind::Texture, group, mRootPath, id);
+
+					if(g.value.has("soundBuffers"))
+						for(const auto& id : g.value["soundBuffers"].forArrAs<std::string>()) enqueue(Kind::SoundBuffer, group, mRootPath, id);
+				}
+
+				ssvu::clampMax(mWorkers, jobs.size());
+				ssvu::clampMin(mWorkers, 1u);
+				for(auto i(0u); i < mWorkers; ++i) workers.emplace_back([this]{ work(); });
+			}
+
+			inline ~AsyncAssetLoader()
+			{
+				{
+					std::lock_guard<std::mutex> lock{mutex};
+					stopping = true;
+					jobs.clear();
+				}
+
+				cvJobs.notify_all();
+				for(auto& w : workers) w.join();
+			}
+
+			inline AsyncAssetLoader(const AsyncAssetLoader&) = delete;
+			inline AsyncAssetLoader& operator=(const AsyncAssetLoader&) = delete;
+
+			inline bool isUsingArchive() const noexcept { return archive.isOpen(); }
+
+			/// @brief Returns where to stream the music track `mID` from (listed in the manifest's "musicStreams").
+			inline MusicSource getMusicSource(const std::string& mID) const
+			{
+				const auto* e(archive.isOpen() ? archive.find(mID) : nullptr);
+				if(e == nullptr || e->kind != Archive::Kind::Music) return {rootPath + mID, nullptr, 0};
+
+				return {"", static_cast<const char*>(archive.getData(*e)), static_cast<SizeT>(e->size)};
+			}
+
+			/// @brief Returns the bitmap font `mID`, from the archive if one is in use.
+			inline ssvs::BitmapFont& getFont(const std::string& mID)
+			{
+				auto itr(fonts.find(mID));
+				return itr != std::end(fonts) ? *itr->second : assetManager.get<ssvs::BitmapFont>(mID);
+			}
+
+			/// @brief Returns a handle to the asset `mID`, which must be listed in one of the groups.
+			template<typename T> inline AssetHandle<T> get(const std::string& mID)
+			{
+				auto& storage(getStorage(static_cast<T*>(nullptr)));
+				auto itr(storage.find(mID));
+
+				SSVU_ASSERT(itr != std::end(storage));
+				return {itr->second};
+			}
+
+			inline bool isResident(const std::string& mGroup) const
+			{
+				auto itr(pending.find(mGroup));
+				return itr != std::end(pending) && itr->second == 0;
+			}
+
+			/// @brief Calls `mFn` on the publishing thread once `mGroup` is resident (immediately if it already is).
+			template<typename TF> inline void whenResident(const std::string& mGroup, TF&& mFn)
+			{
+				if(isResident(mGroup)) { mFn(); return; }
+				onResident[mGroup].emplace_back(ssvu::fwd<TF>(mFn));
+			}
+
+			/// @brief Publishes the assets decoded so far. Call once per frame.
+			inline void update()
+			{
+				decltype(results) ready;
+
+				{
+					std::lock_guard<std::mutex> lock{mutex};
+					ready.swap(results);
+				}
+
+				for(auto& r : ready) publish(r);
+			}
+
+			/// @brief Blocks until `mGroup` is resident, publishing assets as they arrive.
+			inline void waitFor(const std::string& mGroup)
+			{
+				SSVU_ASSERT(pending.count(mGroup) > 0);
+
+				while(!isResident(mGroup))
+				{
+					{
+						std::unique_lock<std::mutex> lock{mutex};
+						cvResults.wait(lock, [this]{ return !results.empty(); });
+					}
+
+					update();
+				}
+			}
+
+			inline std::chrono::milliseconds::rep getElapsedMs() const
+			{
+				return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - startTime).count();
+			}
+
+			/// @brief Logs the time-to-first-frame, measured from the loader's construction.
+			inline void onFrame()
+			{
+				if(firstFrameReported) return;
+
+				firstFrameReported = true;
+				ssvu::lo("Assets") << "First frame after " << getElapsedMs() << "ms\n";
+			}
+	};
+}
+
+#endif
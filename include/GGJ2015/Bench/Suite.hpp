@@ -0,0 +1,131 @@
+#ifndef GGJ2015_BENCH_SUITE
+#define GGJ2015_BENCH_SUITE
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include "../../GGJ2015/Core/Core.hpp"
+
+namespace ggj
+{
+	namespace Bench
+	{
+		using Clock = std::chrono::steady_clock;
+
+		/// @brief Heap allocations made by the process so far. Counted by the replacement
+		/// `operator new` of the benchmark executable.
+		inline auto& getAllocCount() noexcept { static std::atomic<std::uint64_t> result{0}; return result; }
+
+		struct Config
+		{
+			int warmupReps{2};
+			int reps{15};
+			double minRepMs{5.0};		// Iterations per rep are calibrated so that a rep takes at least this long
+			std::string filter;			// Only benchmarks whose name contains this run
+			std::string jsonPath;
+		};
+
+		struct Result
+		{
+			std::string name;
+			SizeT iterations{0};		// Per rep
+			double nsMin{0}, nsMedian{0}, nsMean{0}, nsStdDev{0};
+			double allocsPerIter{0};
+			double itemsPerIter{1}, itemsPerSec{0};		// Items (draws, fights...) processed, at the median time
+		};
+
+		/// @brief Runs benchmarks with warmup and repetition, prints a table and optionally writes JSON.
+		/// A benchmark is a function run once per iteration. Set-up belongs outside of it: everything
+		/// it does is measured, allocations included. An iteration processing several items (a batch)
+		/// passes their count, so that throughput is reported per item.
+		class Suite
+		{
+			private:
+				Config cfg;
+				std::vector<Result> results;
+
+				template<typename TF> inline static double getRepNs(SizeT mIters, TF& mFn)
+				{
+					auto start(Clock::now());
+					for(auto i(0u); i < mIters; ++i) mFn();
+					return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+				}
+
+			public:
+				inline Suite(Config mCfg) : cfg{std::move(mCfg)} { }
+
+				inline bool isEnabled(const std::string& mName) const
+				{
+					return cfg.filter.empty() || mName.find(cfg.filter) != std::string::npos;
+				}
+
+				template<typename TF> inline void run(const std::string& mName, TF mFn, double mItemsPerIter = 1)
+				{
+					if(!isEnabled(mName)) return;
+
+					// Calibration doubles as the first warmup rep
+					SizeT iters{1};
+					while(getRepNs(iters, mFn) < cfg.minRepMs * 1e6 && iters < (SizeT{1} << 30)) iters *= 2;
+					for(auto r(1); r < cfg.warmupReps; ++r) getRepNs(iters, mFn);
+
+					std::vector<double> ns;
+					ns.reserve(cfg.reps);
+					auto allocsBefore(getAllocCount().load());
+
+					for(auto r(0); r < cfg.reps; ++r) ns.emplace_back(getRepNs(iters, mFn) / iters);
+
+					Result result;
+					result.name = mName;
+					result.iterations = iters;
+					result.allocsPerIter = static_cast<double>(getAllocCount().load() - allocsBefore) / (iters * cfg.reps);
+
+					std::sort(std::begin(ns), std::end(ns));
+					result.nsMin = ns.front();
+					result.nsMedian = ns[ns.size() / 2];
+
+					for(auto x : ns) result.nsMean += x;
+					result.nsMean /= ns.size();
+
+					for(auto x : ns) result.nsStdDev += (x - result.nsMean) * (x - result.nsMean);
+					result.nsStdDev = std::sqrt(result.nsStdDev / ns.size());
+
+					result.itemsPerIter = mItemsPerIter;
+					result.itemsPerSec = mItemsPerIter * 1e9 / result.nsMedian;
+
+					std::printf("  %-34s %12.1f %12.1f %10.1f %10.2f %14.0f\n", mName.c_str(), result.nsMedian, result.nsMin, result.nsStdDev, result.allocsPerIter, result.itemsPerSec);
+					results.emplace_back(std::move(result));
+				}
+
+				inline void printHeader() const
+				{
+					std::printf("ggj_bench: %d warmup reps, %d reps of at least %.1fms\n", cfg.warmupReps, cfg.reps, cfg.minRepMs);
+					std::printf("  %-34s %12s %12s %10s %10s %14s\n", "benchmark", "median ns", "min ns", "stddev", "allocs/it", "items/sec");
+				}
+
+				inline bool writeJSON() const
+				{
+					if(cfg.jsonPath.empty()) return true;
+
+					std::ofstream o{cfg.jsonPath};
+					o << "{\n\t\"warmupReps\": " << cfg.warmupReps << ",\n\t\"reps\": " << cfg.reps << ",\n\t\"benchmarks\":\n\t[\n";
+
+					for(auto i(0u); i < results.size(); ++i)
+					{
+						const auto& r(results[i]);
+
+						o << "\t\t{\"name\": \"" << r.name << "\", \"iterations\": " << r.iterations
+						  << ", \"nsMin\": " << r.nsMin << ", \"nsMedian\": " << r.nsMedian << ", \"nsMean\": " << r.nsMean
+						  << ", \"nsStdDev\": " << r.nsStdDev << ", \"allocsPerIter\": " << r.allocsPerIter
+						  << ", \"itemsPerIter\": " << r.itemsPerIter << ", \"itemsPerSec\": " << r.itemsPerSec << "}"
+						  << (i + 1 < results.size() ? ",\n" : "\n");
+					}
+
+					o << "\t]\n}\n";
+					return static_cast<bool>(o);
+				}
+		};
+	}
+}
+
+#endif
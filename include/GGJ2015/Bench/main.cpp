@@ -0,0 +1,234 @@
+#include <cstdlib>
+#include <new>
+#include "../../GGJ2015/Core/Core.hpp"
+#include "../../GGJ2015/Bench/Suite.hpp"
+
+// Micro-benchmarks for the headless core.
+// Usage: ggj_bench [--reps N] [--warmup N] [--filter substring] [--json path] [--batch fights per batch]
+// "items/sec" is draws, fights... per second: batch kernels report fights, so they compare with each other
+// and with `Creature::fight`. Exits with 1 if a vector kernel does not match the scalar one.
+
+using namespace ggj;
+
+// Every heap allocation of the process is counted, for the "allocs/it" column
+void* operator new(std::size_t mSize)
+{
+	++Bench::getAllocCount();
+	if(auto* result = std::malloc(mSize != 0 ? mSize : 1)) return result;
+	throw std::bad_alloc{};
+}
+
+void operator delete(void* mPtr) noexcept { std::free(mPtr); }
+void operator delete(void* mPtr, std::size_t) noexcept { std::free(mPtr); }
+
+namespace
+{
+	volatile int sinkI{0};
+	volatile float sinkF{0.f};
+
+	struct Level
+	{
+		const char* name;
+		int room;
+	};
+
+	constexpr Level levels[]{{"early", 3}, {"mid", 15}, {"late", 35}};
+
+	// A session in the playing state at `mRoom`, always generated from the same seed
+	inline void setupSession(GameSession& mGS, int mRoom)
+	{
+		mGS.seed(42);
+		mGS.restart();
+		while(mGS.roomNumber < mRoom) mGS.advance();
+	}
+
+	inline Creature mkRndCreature(Rng& mRng, int mLevel)
+	{
+		auto elems([&mRng]{ return ElementBitset(mRng.getRnd(0, 16)); });
+
+		Creature result;
+		result.hps = mRng.getRnd(1, mLevel * 20);
+		result.bonusATK = mRng.getRnd(0, mLevel / 2 + 1);
+		result.bonusDEF = mRng.getRnd(0, mLevel / 2 + 1);
+		result.weapon.atk = mRng.getRnd(1, mLevel * 2);
+		result.weapon.strongAgainst = elems();
+		result.weapon.weakAgainst = elems();
+		result.armor.def = mRng.getRnd(0, mLevel);
+		result.armor.elementTypes = elems();
+		return result;
+	}
+
+	inline void benchRng(Bench::Suite& mSuite)
+	{
+		Rng rng{42};
+
+		mSuite.run("ssvu::getRnd(0, 100)", []{ sinkI = ssvu::getRnd(0, 100); });
+		mSuite.run("Rng::getRnd(0, 100)", [&rng]{ sinkI = rng.getRnd(0, 100); });
+		mSuite.run("ssvu::getRndR(0.f, 1.f)", []{ sinkF = ssvu::getRndR(0.f, 1.f); });
+		mSuite.run("Rng::getRndR(0.f, 1.f)", [&rng]{ sinkF = rng.getRndR(0.f, 1.f); });
+	}
+
+	inline void benchGeneration(Bench::Suite& mSuite)
+	{
+		for(const auto& l : levels)
+		{
+			GameSession gs;
+			setupSession(gs, l.room);
+
+			auto suffix(std::string{"/"} + l.name);
+			auto& gen(gs.getRoomGen());
+
+			mSuite.run("RoomGenerator::generateChoices" + suffix, [&gen]{ gen.generateChoices(); });
+			mSuite.run("RoomGenerator::generateCreature" + suffix, [&gen, &l]{ sinkI = gen.generateCreature(l.room).hps; });
+			mSuite.run("RoomGenerator::generateDrops" + suffix, [&gen, &l]{ sinkI = gen.generateDrops(l.room).has(0); });
+		}
+
+		Rng rng{42};
+		mSuite.run("Gen::generateCreatureName", [&rng]{ sinkI = getGen().generateCreatureName(rng).base; });
+	}
+
+	inline void benchCombat(Bench::Suite& mSuite)
+	{
+		constexpr SizeT pairCount{256};
+
+		for(const auto& l : levels)
+		{
+			GameSession gs;
+			setupSession(gs, l.room);
+
+			// Player-like and enemy creatures of the level, as generated for that room
+			std::vector<Creature> as, bs;
+			auto& gen(gs.getRoomGen());
+			for(auto i(0u); i < pairCount; ++i) { as.emplace_back(gen.generateCreature(l.room)); bs.emplace_back(gen.generateCreature(l.room)); }
+
+			SizeT idx{0};
+			mSuite.run(std::string{"Creature::fight/"} + l.name, [&as, &bs, &idx]
+			{
+				auto a(as[idx]), b(bs[idx]);
+				a.fight(b);
+				sinkI = a.hps;
+				idx = (idx + 1) % pairCount;
+			});
+		}
+
+		GameSession gs;
+		setupSession(gs, 15);
+
+		Rng rng{42};
+		std::vector<InstantEffect> ies;
+		for(auto i(0u); i < pairCount; ++i)
+			ies.emplace_back(InstantEffect::Type(rng.getRnd(0, 4)), InstantEffect::Stat(rng.getRnd(0, 3)), rng.getRndR(1.f, 5.f));
+
+		SizeT idx{0};
+		auto player(gs.player);
+		mSuite.run("InstantEffect::apply", [&gs, &ies, &idx, &player]
+		{
+			auto x(player);
+			ies[idx].apply(gs, x);
+			sinkI = x.hps;
+			idx = (idx + 1) % pairCount;
+		});
+	}
+
+	inline void benchLogging(Bench::Suite& mSuite)
+	{
+		// `eventLo` also echoes to `ssvu::lo()`, which writes to `std::cout`: silence it while measuring
+		struct NullBuffer : public std::streambuf
+		{
+			inline int_type overflow(int_type mC) override { return traits_type::not_eof(mC); }
+			inline std::streamsize xsputn(const char*, std::streamsize mSize) override { return mSize; }
+		} nullBuffer;
+
+		auto* coutBuffer(std::cout.rdbuf(&nullBuffer));
+		getEventLogEnabled() = true;
+
+		Creature a, b;
+		a.name = FixedName::Player;
+		b.name = Name::mkGenerated(12);
+
+		mSuite.run("eventLo/names", [&a, &b]{ eventLo() << a.name << " engages " << b.name << "!\n"; });
+		mSuite.run("eventLo/numbers", []{ eventLo() << "You drain " << 12 << " HPS defeating the enemy\n"; });
+		mSuite.run("eventLo/disabled", [&a, &b]
+		{
+			getEventLogEnabled() = false;
+			eventLo() << a.name << " engages " << b.name << "!\n";
+			getEventLogEnabled() = true;
+		});
+
+		getEventLogEnabled() = false;
+		std::cout.rdbuf(coutBuffer);
+	}
+
+	// Returns false if a vector kernel does not match the scalar one
+	inline bool benchBatchFights(Bench::Suite& mSuite, SizeT mSize)
+	{
+		Rng rng{42};
+		CreatureBatch as, bs;
+		for(auto i(0u); i < mSize; ++i) { as.push(mkRndCreature(rng, 40)); bs.push(mkRndCreature(rng, 40)); }
+
+		CreatureBatch refA(as), refB(bs);
+		resolveBatchFights(refA, refB, BatchKernel::Scalar);
+
+		auto best(getBestBatchKernel());
+		auto matches(true);
+
+		for(auto k : {BatchKernel::Scalar, BatchKernel::SSE41, BatchKernel::AVX2})
+		{
+			if(static_cast<int>(k) > static_cast<int>(best)) continue;
+
+			auto name(std::string{"resolveBatchFights/"} + getBatchKernelStr(k));
+			if(!mSuite.isEnabled(name)) continue;
+
+			CreatureBatch a(as), b(bs);
+			resolveBatchFights(a, b, k);
+			if(a.hps != refA.hps || b.hps != refB.hps)
+			{
+				std::fprintf(stderr, "ggj_bench: %s does not match the scalar kernel\n", name.c_str());
+				matches = false;
+			}
+
+			mSuite.run(name, [&]
+			{
+				a.hps = as.hps;
+				b.hps = bs.hps;
+				resolveBatchFights(a, b, k);
+			}, mSize);
+		}
+
+		return matches;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	getEventLogEnabled() = false;
+
+	Bench::Config cfg;
+	SizeT batchSize{1u << 16};
+
+	for(auto i(1); i + 1 < argc; i += 2)
+	{
+		std::string arg{argv[i]}, value{argv[i + 1]};
+
+		if(arg == "--reps") cfg.reps = std::stoi(value);
+		else if(arg == "--warmup") cfg.warmupReps = std::stoi(value);
+		else if(arg == "--filter") cfg.filter = value;
+		else if(arg == "--json") cfg.jsonPath = value;
+		else if(arg == "--batch") batchSize = std::stoul(value);
+		else { std::fprintf(stderr, "ggj_bench: unknown option %s\n", arg.c_str()); return 1; }
+	}
+
+	ssvu::clampMin(cfg.reps, 1);
+
+	Bench::Suite suite{cfg};
+	suite.printHeader();
+
+	benchRng(suite);
+	benchGeneration(suite);
+	benchCombat(suite);
+	benchLogging(suite);
+	auto kernelsMatch(benchBatchFights(suite, batchSize));
+
+	if(!suite.writeJSON()) { std::fprintf(stderr, "ggj_bench: cannot write %s\n", cfg.jsonPath.c_str()); return 1; }
+	return kernelsMatch ? 0 : 1;
+}
@@ -1,8 +1,308 @@
 #ifndef GGJ2015_BOILERPLATE
 #define GGJ2015_BOILERPLATE
 
+#include <chrono>
+
 namespace Boilerplate
 {
+	// Draw calls and texture binds submitted during the current and the previous frame.
+	struct RenderStats
+	{
+		ssvu::SizeT drawCalls{0}, lastDrawCalls{0};
+		ssvu::SizeT textureBinds{0}, lastTextureBinds{0};
+		const void* lastTexture{nullptr};
+
+		inline void beginFrame() noexcept
+		{
+			lastDrawCalls = drawCalls;
+			lastTextureBinds = textureBinds;
+			drawCalls = textureBinds = 0;
+			lastTexture = nullptr;
+		}
+
+		/// @brief Records a draw call using the texture identified by `mTexture`.
+		inline void onDraw(const void* mTexture) noexcept
+		{
+			++drawCalls;
+			if(mTexture == lastTexture) return;
+
+			++textureBinds;
+			lastTexture = mTexture;
+		}
+	};
+
+	inline auto& getRenderStats() noexcept { static RenderStats result; return result; }
+
+	/// @brief Key-to-present latency: from a key press being received to the presentation of the
+	/// first frame drawn after it. SFML does not report when a frame is presented, so a frame counts
+	/// as presented when the next one starts drawing, once `display` has returned.
+	class InputLatency
+	{
+		public:
+			using Clock = std::chrono::steady_clock;
+
+		private:
+			Clock::time_point pressTime;
+			bool pending{false}, drawn{false};
+			float lastMs{0.f}, maxMs{0.f};
+			double totalMs{0.0};
+			ssvu::SizeT samples{0};
+
+		public:
+			/// @brief Records a press received at `mTime`. Presses before the frame showing the previous
+			/// one is presented are not measured. Returns true if this one is.
+			inline bool onPress(Clock::time_point mTime) noexcept
+			{
+				if(pending) return false;
+
+				pressTime = mTime;
+				pending = true;
+				drawn = false;
+				return true;
+			}
+
+			inline void beginFrame() noexcept
+			{
+				if(!drawn) return;
+
+				lastMs = std::chrono::duration<float, std::milli>(Clock::now() - pressTime).count();
+				ssvu::clampMin(maxMs, lastMs);
+				totalMs += lastMs;
+				++samples;
+
+				pending = drawn = false;
+			}
+
+			/// @brief `mHandled` tells whether the frame shows the result of the pending press: when input
+			/// is handled on another thread, frames drawn before it was are not counted.
+			inline void endFrame(bool mHandled = true) noexcept { drawn = pending && mHandled; }
+
+			inline float getLastMs() const noexcept { return lastMs; }
+			inline float getMaxMs() const noexcept { return maxMs; }
+			inline float getMeanMs() const noexcept { return samples == 0 ? 0.f : totalMs / samples; }
+	};
+
+	namespace Impl
+	{
+		// Texture identity used by `RenderStats`. The textures of other drawables (bitmap fonts, shapes)
+		// are not exposed, so each drawable type counts as a single texture.
+		inline const void* getTextureID(const sf::Sprite& mX) noexcept { return mX.getTexture(); }
+		template<typename T> inline const void* getTextureID(const T&) noexcept { return &typeid(T); }
+	}
+
+	/// @brief Packs many small textures into a single one, so that sprites using any of them
+	/// can be submitted together by a `SpriteBatch`.
+	class TextureAtlas
+	{
+		private:
+			sf::Texture texture;
+			std::map<const sf::Texture*, sf::IntRect> regions;
+
+		public:
+			/// @brief Packs `mTextures` in rows (tallest first), with one pixel of padding between regions.
+			inline void build(std::vector<const sf::Texture*> mTextures, unsigned int mWidth = 512)
+			{
+				constexpr unsigned int padding{1};
+
+				std::sort(std::begin(mTextures), std::end(mTextures), [](const auto* mA, const auto* mB)
+				{
+					return mA->getSize().y > mB->getSize().y;
+				});
+
+				regions.clear();
+				unsigned int x{0}, y{0}, rowHeight{0};
+
+				for(const auto* t : mTextures)
+				{
+					auto size(t->getSize());
+					SSVU_ASSERT(size.x <= mWidth);
+
+					if(x + size.x > mWidth)
+					{
+						x = 0;
+						y += rowHeight + padding;
+						rowHeight = 0;
+					}
+
+					regions[t] = sf::IntRect(x, y, size.x, size.y);
+					x += size.x + padding;
+					ssvu::clampMin(rowHeight, size.y);
+				}
+
+				sf::Image image;
+				image.create(mWidth, y + rowHeight, sf::Color::Transparent);
+
+				for(const auto& r : regions) image.copy(r.first->copyToImage(), r.second.left, r.second.top);
+
+				texture.loadFromImage(image);
+			}
+
+			inline const sf::IntRect* getRegion(const sf::Texture& mX) const
+			{
+				auto itr(regions.find(&mX));
+				return itr == std::end(regions) ? nullptr : &itr->second;
+			}
+
+			inline const auto& getTexture() const noexcept { return texture; }
+	};
+
+	class SpriteBatch;
+
+	/// @brief Batch that `draw` currently submits to, if any.
+	inline auto& getActiveSpriteBatch() noexcept { static SpriteBatch* result{nullptr}; return result; }
+
+	/// @brief Collects the sprites drawn on one target between `begin` and `end` into a single
+	/// vertex array over a `TextureAtlas`. Other drawables (text, shapes, sprites outside the atlas)
+	/// are drawn after the sprites, in submission order: batches suit sprites drawn below text.
+	/// Deferred drawables are kept by address, so they must not change until `end`.
+	class SpriteBatch
+	{
+		private:
+			struct Deferred
+			{
+				const sf::Drawable* drawable;
+				sf::RenderStates states;
+				sf::Sprite sprite;		// Copy of non-atlas sprites, which are often temporaries
+			};
+
+			const TextureAtlas& atlas;
+			sf::VertexArray vertices{sf::Quads};
+			std::vector<Deferred> deferred;
+			const void* target{nullptr};
+
+		public:
+			inline SpriteBatch(const TextureAtlas& mAtlas) : atlas{mAtlas} { }
+
+			/// @brief Makes this the active batch: `draw` calls on `mTarget` are collected until `end`.
+			template<typename TTarget> inline void begin(TTarget& mTarget) noexcept
+			{
+				SSVU_ASSERT(getActiveSpriteBatch() == nullptr);
+				getActiveSpriteBatch() = this;
+				target = &mTarget;
+			}
+
+			template<typename TTarget> inline bool submit(TTarget& mTarget, const sf::Sprite& mX, const sf::RenderStates& mStates)
+			{
+				if(target != &mTarget) return false;
+
+				const auto* region(mX.getTexture() == nullptr ? nullptr : atlas.getRegion(*mX.getTexture()));
+				if(region == nullptr || &mStates != &sf::RenderStates::Default)
+				{
+					deferred.emplace_back(Deferred{nullptr, mStates, mX});
+					return true;
+				}
+
+				const auto& tr(mX.getTextureRect());
+				const auto& transform(mX.getTransform());
+				auto w(static_cast<float>(std::abs(tr.width))), h(static_cast<float>(std::abs(tr.height)));
+				auto u(static_cast<float>(region->left + tr.left)), v(static_cast<float>(region->top + tr.top));
+				auto uw(static_cast<float>(tr.width)), vh(static_cast<float>(tr.height));
+
+				vertices.append(sf::Vertex(transform.transformPoint(0.f, 0.f), mX.getColor(), sf::Vector2f(u, v)));
+				vertices.append(sf::Vertex(transform.transformPoint(w, 0.f), mX.getColor(), sf::Vector2f(u + uw, v)));
+				vertices.append(sf::Vertex(transform.transformPoint(w, h), mX.getColor(), sf::Vector2f(u + uw, v + vh)));
+				vertices.append(sf::Vertex(transform.transformPoint(0.f, h), mX.getColor(), sf::Vector2f(u, v + vh)));
+				return true;
+			}
+
+			template<typename TTarget> inline bool submit(TTarget& mTarget, const sf::Drawable& mX, const sf::RenderStates& mStates)
+			{
+				if(target != &mTarget) return false;
+
+				deferred.emplace_back(Deferred{&mX, mStates, sf::Sprite{}});
+				return true;
+			}
+
+			template<typename TTarget> inline void end(TTarget& mTarget)
+			{
+				SSVU_ASSERT(target == &mTarget);
+				getActiveSpriteBatch() = nullptr;
+				target = nullptr;
+
+				auto& stats(getRenderStats());
+
+				if(vertices.getVertexCount() > 0)
+				{
+					sf::RenderStates states;
+					states.texture = &atlas.getTexture();
+
+					stats.onDraw(states.texture);
+					mTarget.draw(vertices, states);
+					vertices.clear();
+				}
+
+				for(const auto& d : deferred)
+				{
+					if(d.drawable == nullptr)
+					{
+						stats.onDraw(Impl::getTextureID(d.sprite));
+						mTarget.draw(d.sprite, d.states);
+					}
+					else
+					{
+						stats.onDraw(&typeid(*d.drawable));
+						mTarget.draw(*d.drawable, d.states);
+					}
+				}
+
+				deferred.clear();
+			}
+	};
+
+	/// @brief Draws `mX` through `mTarget` (a `GameWindow` or any `sf::RenderTarget`), or submits it
+	/// to the active `SpriteBatch` if it targets the same window. Counts draw calls and texture binds.
+	template<typename TTarget, typename T> inline void draw(TTarget& mTarget, const T& mX, const sf::RenderStates& mStates = sf::RenderStates::Default)
+	{
+		auto* batch(getActiveSpriteBatch());
+		if(batch != nullptr && batch->submit(mTarget, mX, mStates)) return;
+
+		getRenderStats().onDraw(Impl::getTextureID(mX));
+		mTarget.draw(mX, mStates);
+	}
+
+	/// @brief Off-screen cache for content that rarely changes. The content is rendered into a texture
+	/// by `mFn` only after `invalidate`, and is otherwise composited with a single sprite draw.
+	class RenderLayer
+	{
+		private:
+			sf::RenderTexture renderTexture;
+			sf::Sprite sprite;
+			bool valid{false};
+
+		public:
+			inline void create(unsigned int mWidth, unsigned int mHeight)
+			{
+				renderTexture.create(mWidth, mHeight);
+				sprite.setTexture(renderTexture.getTexture(), true);
+				valid = false;
+			}
+
+			inline void invalidate() noexcept { valid = false; }
+			inline bool isValid() const noexcept { return valid; }
+
+			template<typename TTarget, typename TF> inline void draw(TTarget& mTarget, const TF& mFn)
+			{
+				if(!valid)
+				{
+					renderTexture.clear(sf::Color::Transparent);
+					mFn(renderTexture);
+					renderTexture.display();
+					valid = true;
+				}
+
+				Boilerplate::draw(mTarget, sprite);
+			}
+	};
+
+	/// @brief Main loop settings. Times are in frame time units (1/60 of a second).
+	struct LoopConfig
+	{
+		float timestep{0.5f};		// Simulated time per update
+		float maxCatchUp{8.f};		// Updates run at most per frame: after a stall, the rest of the backlog is dropped
+		bool vsync{false};			// Paces frames on the display instead of `maxFPS`
+		float maxFPS{200.f};		// Frame rate limit without vsync, 0 for none
+	};
+
 	class App
 	{
 		protected:
@@ -20,9 +320,9 @@ namespace Boilerplate
 
 			inline void stop() noexcept	{ return gameWindow.stop(); }
 
-			template<typename... TArgs> inline void render(TArgs&&... mArgs)
+			template<typename... TArgs> inline void render(const TArgs&... mArgs)
 			{
-				gameWindow.draw(ssvu::fwd<TArgs>(mArgs)...);
+				Boilerplate::draw(gameWindow, mArgs...);
 			}
 
 			inline auto& getGameState() noexcept				{ return gameState; }
@@ -40,17 +340,19 @@ namespace Boilerplate
 			ssvu::AlignedStorageFor<T> app;
 
 		public:
-			inline AppRunner(const std::string& mTitle, ssvu::SizeT mWidth, ssvu::SizeT mHeight)
+			template<typename... TArgs> inline AppRunner(const std::string& mTitle, ssvu::SizeT mWidth, ssvu::SizeT mHeight,
+				const LoopConfig& mLoop, TArgs&&... mArgs)
 			{
 				gameWindow.setTitle(mTitle);
-				gameWindow.setTimer<ssvs::TimerStatic>(0.5f, 0.5f);
+				gameWindow.setTimer<ssvs::TimerStatic>(mLoop.timestep, mLoop.timestep, mLoop.maxCatchUp);
 				gameWindow.setSize(mWidth, mHeight);
 				gameWindow.setFullscreen(false);
-				gameWindow.setFPSLimited(true);
-				gameWindow.setMaxFPS(200);
+				gameWindow.setVsync(mLoop.vsync);
+				gameWindow.setFPSLimited(!mLoop.vsync && mLoop.maxFPS > 0.f);
+				gameWindow.setMaxFPS(mLoop.maxFPS);
 				gameWindow.setPixelMult(2);
 
-				new(&app) T{gameWindow};
+				new(&app) T{gameWindow, mLoop, ssvu::fwd<TArgs>(mArgs)...};
 
 				gameWindow.setGameState(reinterpret_cast<T&>(app).getGameState());
 				gameWindow.run();
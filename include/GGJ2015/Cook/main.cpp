@@ -0,0 +1,254 @@
+#include <chrono>
+#include "../../GGJ2015/Common.hpp"
+#include "../../GGJ2015/AssetArchive.hpp"
+
+// Packs a data directory into a single archive (see AssetArchive.hpp).
+// With `--bench`, compares cold and warm startup loading from loose files and from the archive.
+// Usage: ggj_cook [data dir] [--bench]
+
+using namespace ggj;
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	struct Source
+	{
+		Archive::Kind kind;
+		std::string group, id;
+		std::string fontTexture, fontData;		// Fonts only: texture id and metadata file
+	};
+
+	// Everything the manifest references: top-level assets and fonts (loaded at startup), then the groups.
+	inline auto getSources(const ssvj::Val& mManifest)
+	{
+		std::vector<Source> result;
+
+		auto addLists([&result](const ssvj::Val& mX, const std::string& mGroup)
+		{
+			if(mX.has("textures"))
+				for(const auto& id : mX["textures"].forArrAs<std::string>()) result.emplace_back(Source{Archive::Kind::Texture, mGroup, id, "", ""});
+
+			if(mX.has("soundBuffers"))
+				for(const auto& id : mX["soundBuffers"].forArrAs<std::string>()) result.emplace_back(Source{Archive::Kind::SoundBuffer, mGroup, id, "", ""});
+		});
+
+		addLists(mManifest, "");
+
+		if(mManifest.has("musicStreams"))
+			for(const auto& id : mManifest["musicStreams"].forArrAs<std::string>()) result.emplace_back(Source{Archive::Kind::Music, "", id, "", ""});
+
+		if(mManifest.has("bitmapFonts"))
+			for(const auto& f : mManifest["bitmapFonts"].forObj())
+				result.emplace_back(Source{Archive::Kind::Font, "", f.key, f.value[0].as<std::string>(), f.value[1].as<std::string>()});
+
+		if(mManifest.has("groups"))
+			for(const auto& g : mManifest["groups"].forObj()) addLists(g.value, g.key);
+
+		return result;
+	}
+
+	template<typename T> inline void append(std::vector<char>& mBlob, const T* mData, SizeT mCount)
+	{
+		const auto* bytes(reinterpret_cast<const char*>(mData));
+		mBlob.insert(std::end(mBlob), bytes, bytes + mCount * sizeof(T));
+	}
+
+	inline SizeT getAligned(SizeT mX) noexcept { return (mX + Archive::blobAlign - 1) / Archive::blobAlign * Archive::blobAlign; }
+
+	inline bool cookSource(const std::string& mDir, const Source& mSrc, Archive::Entry& mEntry, std::vector<char>& mBlob)
+	{
+		if(mSrc.id.size() >= Archive::idLength || mSrc.group.size() >= Archive::groupLength)
+		{
+			std::fprintf(stderr, "cook: id or group too long: %s (%s)\n", mSrc.id.c_str(), mSrc.group.c_str());
+			return false;
+		}
+
+		std::memset(&mEntry, 0, sizeof(mEntry));
+		std::strncpy(mEntry.id, mSrc.id.c_str(), Archive::idLength);
+		std::strncpy(mEntry.group, mSrc.group.c_str(), Archive::groupLength);
+		mEntry.kind = mSrc.kind;
+
+		if(mSrc.kind == Archive::Kind::Texture)
+		{
+			sf::Image image;
+			if(!image.loadFromFile(mDir + mSrc.id)) return false;
+
+			mEntry.a = image.getSize().x;
+			mEntry.b = image.getSize().y;
+			append(mBlob, image.getPixelsPtr(), SizeT(mEntry.a) * mEntry.b * 4);
+		}
+		else if(mSrc.kind == Archive::Kind::SoundBuffer)
+		{
+			sf::SoundBuffer soundBuffer;
+			if(!soundBuffer.loadFromFile(mDir + mSrc.id)) return false;
+
+			mEntry.a = soundBuffer.getChannelCount();
+			mEntry.b = soundBuffer.getSampleRate();
+			append(mBlob, soundBuffer.getSamples(), soundBuffer.getSampleCount());
+		}
+		else if(mSrc.kind == Archive::Kind::Music)
+		{
+			std::ifstream f{mDir + mSrc.id, std::ios::binary};
+			if(!f) return false;
+
+			mBlob.assign(std::istreambuf_iterator<char>{f}, std::istreambuf_iterator<char>{});
+		}
+		else
+		{
+			auto data(ssvj::Val::fromFile(mDir + mSrc.fontData));
+
+			std::uint32_t fields[4];
+			for(auto i(0u); i < 4; ++i) fields[i] = data[i].as<int>();
+
+			append(mBlob, fields, 4);
+			append(mBlob, mSrc.fontTexture.c_str(), mSrc.fontTexture.size() + 1);
+		}
+
+		mEntry.size = mBlob.size();
+		return true;
+	}
+
+	inline bool cook(const std::string& mDir)
+	{
+		auto sources(getSources(ssvj::Val::fromFile(mDir + "assets.json")));
+		auto count(sources.size());
+
+		std::vector<Archive::Entry> entries(count);
+		std::vector<std::vector<char>> blobs(count);
+
+		for(auto i(0u); i < count; ++i)
+		{
+			if(cookSource(mDir, sources[i], entries[i], blobs[i])) continue;
+
+			std::fprintf(stderr, "cook: cannot load %s\n", sources[i].id.c_str());
+			return false;
+		}
+
+		// The index is sorted by id, so that `AssetArchive::find` can binary search it
+		std::vector<SizeT> order(count);
+		for(auto i(0u); i < count; ++i) order[i] = i;
+		std::sort(std::begin(order), std::end(order), [&entries](SizeT mA, SizeT mB){ return entries[mA] < entries[mB]; });
+
+		Archive::Header header{Archive::magic, Archive::version, static_cast<std::uint32_t>(count), 0};
+		std::vector<Archive::Entry> table(count);
+
+		auto offset(getAligned(sizeof(header) + count * sizeof(Archive::Entry)));
+		for(auto i(0u); i < count; ++i)
+		{
+			table[i] = entries[order[i]];
+			table[i].offset = offset;
+			offset = getAligned(offset + table[i].size);
+		}
+
+		auto path(mDir + Archive::fileName);
+		std::ofstream o{path, std::ios::binary | std::ios::trunc};
+
+		auto pad([&o]{ while(static_cast<SizeT>(o.tellp()) % Archive::blobAlign != 0) o.put('\0'); });
+
+		o.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		o.write(reinterpret_cast<const char*>(table.data()), count * sizeof(Archive::Entry));
+
+		for(auto i(0u); i < count; ++i)
+		{
+			pad();
+			const auto& blob(blobs[order[i]]);
+			o.write(blob.data(), blob.size());
+		}
+
+		pad();
+		if(!o) { std::fprintf(stderr, "cook: cannot write %s\n", path.c_str()); return false; }
+
+		std::printf("cooked %zu assets into %s (%zu bytes)\n", count, path.c_str(), offset);
+		return true;
+	}
+
+	// Drops a file's pages from the OS cache, so the next read comes from disk. Not available everywhere:
+	// there, "cold" runs are warm too.
+	inline void evict(const std::string& mPath)
+	{
+#if defined(POSIX_FADV_DONTNEED)
+		auto fd(::open(mPath.c_str(), O_RDONLY));
+		if(fd < 0) return;
+
+		::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+		::close(fd);
+#else
+		(void) mPath;
+#endif
+	}
+
+	// The CPU side of startup with the current loader: parse the manifest, then read and decode every file.
+	// Music is streamed while playing in both cases, so it is left out.
+	inline void loadLoose(const std::string& mDir)
+	{
+		for(const auto& s : getSources(ssvj::Val::fromFile(mDir + "assets.json")))
+		{
+			if(s.kind == Archive::Kind::Texture) { sf::Image image; image.loadFromFile(mDir + s.id); }
+			else if(s.kind == Archive::Kind::SoundBuffer) { sf::SoundBuffer soundBuffer; soundBuffer.loadFromFile(mDir + s.id); }
+			else if(s.kind == Archive::Kind::Font) ssvj::Val::fromFile(mDir + s.fontData);
+		}
+	}
+
+	// The same work from the archive: map it, then hand every blob to SFML as the loader does.
+	inline void loadArchive(const std::string& mDir)
+	{
+		AssetArchive archive;
+		if(!archive.open(mDir + Archive::fileName)) return;
+
+		for(const auto& e : archive)
+		{
+			if(e.kind == Archive::Kind::Texture) { sf::Image image; image.create(e.a, e.b, static_cast<const sf::Uint8*>(archive.getData(e))); }
+			else if(e.kind == Archive::Kind::SoundBuffer) { sf::SoundBuffer soundBuffer; archive.load(soundBuffer, e); }
+			else if(e.kind == Archive::Kind::Font) archive.getFontData(e);
+		}
+	}
+
+	template<typename TEvict, typename TLoad> inline double getBestMs(int mReps, const TEvict& mEvict, const TLoad& mLoad)
+	{
+		auto best(std::numeric_limits<double>::max());
+
+		for(auto r(0); r < mReps; ++r)
+		{
+			mEvict();
+
+			auto start(Clock::now());
+			mLoad();
+			ssvu::clampMax(best, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+		}
+
+		return best;
+	}
+
+	inline void bench(const std::string& mDir)
+	{
+		constexpr int reps{5};
+
+		std::vector<std::string> looseFiles{mDir + "assets.json"};
+		for(const auto& s : getSources(ssvj::Val::fromFile(mDir + "assets.json")))
+			if(s.kind != Archive::Kind::Music) looseFiles.emplace_back(mDir + (s.kind == Archive::Kind::Font ? s.fontData : s.id));
+
+		auto evictLoose([&looseFiles]{ for(const auto& f : looseFiles) evict(f); });
+		auto evictArchive([&mDir]{ evict(mDir + Archive::fileName); });
+		auto none([]{ });
+
+		std::printf("startup: best of %d, %zu loose files vs. 1 archive\n", reps, looseFiles.size());
+		std::printf("  %-10s %12s %12s\n", "", "cold (ms)", "warm (ms)");
+
+		auto report([](const char* mName, double mCold, double mWarm){ std::printf("  %-10s %12.2f %12.2f\n", mName, mCold, mWarm); });
+
+		report("loose", getBestMs(reps, evictLoose, [&mDir]{ loadLoose(mDir); }), getBestMs(reps, none, [&mDir]{ loadLoose(mDir); }));
+		report("archive", getBestMs(reps, evictArchive, [&mDir]{ loadArchive(mDir); }), getBestMs(reps, none, [&mDir]{ loadArchive(mDir); }));
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::string dir{argc > 1 ? argv[1] : "Data/"};
+	if(!dir.empty() && dir.back() != '/') dir += '/';
+
+	if(!cook(dir)) return 1;
+	if(argc > 2 && std::string{argv[2]} == "--bench") bench(dir);
+
+	return 0;
+}
@@ -0,0 +1,264 @@
+#include <cstring>
+#include "../../GGJ2015/Core/Batch.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+	#define GGJ_BATCH_X86 1
+	#include <immintrin.h>
+	#define GGJ_TARGET_SSE41 __attribute__((target("sse4.1")))
+	#define GGJ_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace ggj
+{
+	namespace Impl
+	{
+		// Fighters that can never kill each other are marked with `infiniteHits`, which compares
+		// greater than any reachable number of hits.
+		static constexpr int infiniteHits{std::numeric_limits<int>::max()};
+
+		inline HPS getBatchDamageScalar(const CreatureBatch& mA, const CreatureBatch& mD, SizeT mI) noexcept
+		{
+			auto result((mA.atk[mI] + mA.bonusATK[mI]) - (mD.def[mI] + mD.bonusDEF[mI]));
+			if(mA.strongAgainst[mI] & mD.elementTypes[mI]) result = Calculations::applyBonus(result);
+			if(mA.weakAgainst[mI] & mD.elementTypes[mI]) result = Calculations::applyMalus(result);
+			return ssvu::getClampedMin(result, 0);
+		}
+
+		inline void computeBatchDamageScalar(const CreatureBatch& mA, const CreatureBatch& mD, HPS* mOut, SizeT mBegin, SizeT mEnd) noexcept
+		{
+			for(auto i(mBegin); i < mEnd; ++i) mOut[i] = getBatchDamageScalar(mA, mD, i);
+		}
+
+		inline void resolveBatchFightsScalar(HPS* mHPSA, const HPS* mDmgA, HPS* mHPSB, const HPS* mDmgB, SizeT mBegin, SizeT mEnd) noexcept
+		{
+			for(auto i(mBegin); i < mEnd; ++i)
+			{
+				auto r(Calculations::resolveFight(mHPSA[i], mDmgA[i], mHPSB[i], mDmgB[i]));
+				mHPSA[i] = r.hps;
+				mHPSB[i] = r.xHPS;
+			}
+		}
+
+		// Clamping to zero before applying the multipliers is equivalent to clamping after them, as both
+		// preserve the sign. On non-negative values `x * 5 / 2` is a shift-add, and truncating `x * 0.8f`
+		// equals `x * 4 / 5` for `x < 2^21`.
+
+#if GGJ_BATCH_X86
+		GGJ_TARGET_SSE41 inline __m128i loadElemsSSE41(const std::uint8_t* mP) noexcept
+		{
+			std::int32_t x;
+			std::memcpy(&x, mP, sizeof(x));
+			return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(x));
+		}
+
+		GGJ_TARGET_SSE41 inline __m128i loadSSE41(const int* mP) noexcept
+		{
+			return _mm_loadu_si128(reinterpret_cast<const __m128i*>(mP));
+		}
+
+		GGJ_TARGET_SSE41 SizeT computeBatchDamageSSE41(const CreatureBatch& mA, const CreatureBatch& mD, HPS* mOut, SizeT mSize) noexcept
+		{
+			const auto zero(_mm_setzero_si128());
+			const auto malus(_mm_set1_ps(Constants::malusMultiplier));
+
+			SizeT i{0};
+			for(; i + 4 <= mSize; i += 4)
+			{
+				auto x(_mm_sub_epi32(_mm_add_epi32(loadSSE41(&mA.atk[i]), loadSSE41(&mA.bonusATK[i])),
+					_mm_add_epi32(loadSSE41(&mD.def[i]), loadSSE41(&mD.bonusDEF[i]))));
+				x = _mm_max_epi32(x, zero);
+
+				auto types(loadElemsSSE41(&mD.elementTypes[i]));
+				auto strong(_mm_cmpgt_epi32(_mm_and_si128(loadElemsSSE41(&mA.strongAgainst[i]), types), zero));
+				auto weak(_mm_cmpgt_epi32(_mm_and_si128(loadElemsSSE41(&mA.weakAgainst[i]), types), zero));
+
+				auto bonus(_mm_srai_epi32(_mm_add_epi32(_mm_slli_epi32(x, 2), x), 1));
+				x = _mm_blendv_epi8(x, bonus, strong);
+
+				auto malused(_mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(x), malus)));
+				x = _mm_blendv_epi8(x, malused, weak);
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(mOut + i), x);
+			}
+
+			return i;
+		}
+
+		GGJ_TARGET_SSE41 inline __m128i getHitsToKillSSE41(__m128i mHPS, __m128i mDmg) noexcept
+		{
+			const auto one(_mm_set1_epi32(1));
+
+			auto q(_mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(_mm_sub_epi32(_mm_add_epi32(mHPS, mDmg), one)), _mm_cvtepi32_ps(mDmg))));
+			q = _mm_blendv_epi8(q, _mm_set1_epi32(infiniteHits), _mm_cmpgt_epi32(one, mDmg));
+			return _mm_blendv_epi8(q, one, _mm_cmpgt_epi32(one, mHPS));
+		}
+
+		GGJ_TARGET_SSE41 SizeT resolveBatchFightsSSE41(HPS* mHPSA, const HPS* mDmgA, HPS* mHPSB, const HPS* mDmgB, SizeT mSize) noexcept
+		{
+			const auto zero(_mm_setzero_si128());
+			const auto inf(_mm_set1_epi32(infiniteHits));
+
+			SizeT i{0};
+			for(; i + 4 <= mSize; i += 4)
+			{
+				auto hpsA(loadSSE41(mHPSA + i)), dmgA(loadSSE41(mDmgA + i));
+				auto hpsB(loadSSE41(mHPSB + i)), dmgB(loadSSE41(mDmgB + i));
+
+				auto hitsToKillB(getHitsToKillSSE41(hpsB, dmgA));
+				auto hitsToKillA(getHitsToKillSSE41(hpsA, dmgB));
+
+				auto stalemate(_mm_and_si128(_mm_cmpeq_epi32(hitsToKillB, inf), _mm_cmpeq_epi32(hitsToKillA, inf)));
+				auto aWins(_mm_andnot_si128(_mm_or_si128(stalemate, _mm_cmpgt_epi32(hitsToKillB, hitsToKillA)), _mm_set1_epi32(-1)));
+
+				// Hits landed on B, and hits landed on A (one less if A lands the killing blow)
+				auto hitsOnB(_mm_blendv_epi8(_mm_blendv_epi8(hitsToKillA, hitsToKillB, aWins), zero, stalemate));
+				auto hitsOnA(_mm_add_epi32(hitsOnB, aWins));
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(mHPSA + i), _mm_sub_epi32(hpsA, _mm_mullo_epi32(hitsOnA, dmgB)));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(mHPSB + i), _mm_sub_epi32(hpsB, _mm_mullo_epi32(hitsOnB, dmgA)));
+			}
+
+			return i;
+		}
+
+		GGJ_TARGET_AVX2 inline __m256i loadElemsAVX2(const std::uint8_t* mP) noexcept
+		{
+			return _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(mP)));
+		}
+
+		GGJ_TARGET_AVX2 inline __m256i loadAVX2(const int* mP) noexcept
+		{
+			return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mP));
+		}
+
+		GGJ_TARGET_AVX2 SizeT computeBatchDamageAVX2(const CreatureBatch& mA, const CreatureBatch& mD, HPS* mOut, SizeT mSize) noexcept
+		{
+			const auto zero(_mm256_setzero_si256());
+			const auto malus(_mm256_set1_ps(Constants::malusMultiplier));
+
+			SizeT i{0};
+			for(; i + 8 <= mSize; i += 8)
+			{
+				auto x(_mm256_sub_epi32(_mm256_add_epi32(loadAVX2(&mA.atk[i]), loadAVX2(&mA.bonusATK[i])),
+					_mm256_add_epi32(loadAVX2(&mD.def[i]), loadAVX2(&mD.bonusDEF[i]))));
+				x = _mm256_max_epi32(x, zero);
+
+				auto types(loadElemsAVX2(&mD.elementTypes[i]));
+				auto strong(_mm256_cmpgt_epi32(_mm256_and_si256(loadElemsAVX2(&mA.strongAgainst[i]), types), zero));
+				auto weak(_mm256_cmpgt_epi32(_mm256_and_si256(loadElemsAVX2(&mA.weakAgainst[i]), types), zero));
+
+				auto bonus(_mm256_srai_epi32(_mm256_add_epi32(_mm256_slli_epi32(x, 2), x), 1));
+				x = _mm256_blendv_epi8(x, bonus, strong);
+
+				auto malused(_mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(x), malus)));
+				x = _mm256_blendv_epi8(x, malused, weak);
+
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(mOut + i), x);
+			}
+
+			return i;
+		}
+
+		GGJ_TARGET_AVX2 inline __m256i getHitsToKillAVX2(__m256i mHPS, __m256i mDmg) noexcept
+		{
+			const auto one(_mm256_set1_epi32(1));
+
+			auto q(_mm256_cvttps_epi32(_mm256_div_ps(_mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_add_epi32(mHPS, mDmg), one)), _mm256_cvtepi32_ps(mDmg))));
+			q = _mm256_blendv_epi8(q, _mm256_set1_epi32(infiniteHits), _mm256_cmpgt_epi32(one, mDmg));
+			return _mm256_blendv_epi8(q, one, _mm256_cmpgt_epi32(one, mHPS));
+		}
+
+		GGJ_TARGET_AVX2 SizeT resolveBatchFightsAVX2(HPS* mHPSA, const HPS* mDmgA, HPS* mHPSB, const HPS* mDmgB, SizeT mSize) noexcept
+		{
+			const auto zero(_mm256_setzero_si256());
+			const auto inf(_mm256_set1_epi32(infiniteHits));
+
+			SizeT i{0};
+			for(; i + 8 <= mSize; i += 8)
+			{
+				auto hpsA(loadAVX2(mHPSA + i)), dmgA(loadAVX2(mDmgA + i));
+				auto hpsB(loadAVX2(mHPSB + i)), dmgB(loadAVX2(mDmgB + i));
+
+				auto hitsToKillB(getHitsToKillAVX2(hpsB, dmgA));
+				auto hitsToKillA(getHitsToKillAVX2(hpsA, dmgB));
+
+				auto stalemate(_mm256_and_si256(_mm256_cmpeq_epi32(hitsToKillB, inf), _mm256_cmpeq_epi32(hitsToKillA, inf)));
+				auto aWins(_mm256_andnot_si256(_mm256_or_si256(stalemate, _mm256_cmpgt_epi32(hitsToKillB, hitsToKillA)), _mm256_set1_epi32(-1)));
+
+				// Hits landed on B, and hits landed on A (one less if A lands the killing blow)
+				auto hitsOnB(_mm256_blendv_epi8(_mm256_blendv_epi8(hitsToKillA, hitsToKillB, aWins), zero, stalemate));
+				auto hitsOnA(_mm256_add_epi32(hitsOnB, aWins));
+
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(mHPSA + i), _mm256_sub_epi32(hpsA, _mm256_mullo_epi32(hitsOnA, dmgB)));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(mHPSB + i), _mm256_sub_epi32(hpsB, _mm256_mullo_epi32(hitsOnB, dmgA)));
+			}
+
+			return i;
+		}
+#endif
+	}
+
+	BatchKernel getBestBatchKernel() noexcept
+	{
+#if GGJ_BATCH_X86
+		static BatchKernel result
+		{
+			__builtin_cpu_supports("avx2") ? BatchKernel::AVX2 :
+			__builtin_cpu_supports("sse4.1") ? BatchKernel::SSE41 : BatchKernel::Scalar
+		};
+
+		return result;
+#else
+		return BatchKernel::Scalar;
+#endif
+	}
+
+	const char* getBatchKernelStr(BatchKernel mX) noexcept
+	{
+		static auto array(ssvu::makeArray
+		(
+			"scalar",
+			"sse4.1",
+			"avx2"
+		));
+
+		return array[static_cast<int>(mX)];
+	}
+
+	void computeBatchDamage(const CreatureBatch& mAttackers, const CreatureBatch& mDefenders, HPS* mOut, BatchKernel mKernel)
+	{
+		SSVU_ASSERT(mAttackers.size() == mDefenders.size());
+
+		auto size(mAttackers.size());
+		SizeT done{0};
+
+#if GGJ_BATCH_X86
+		if(mKernel == BatchKernel::AVX2) done = Impl::computeBatchDamageAVX2(mAttackers, mDefenders, mOut, size);
+		else if(mKernel == BatchKernel::SSE41) done = Impl::computeBatchDamageSSE41(mAttackers, mDefenders, mOut, size);
+#else
+		(void) mKernel;
+#endif
+
+		Impl::computeBatchDamageScalar(mAttackers, mDefenders, mOut, done, size);
+	}
+
+	void resolveBatchFights(CreatureBatch& mA, CreatureBatch& mB, BatchKernel mKernel)
+	{
+		SSVU_ASSERT(mA.size() == mB.size());
+
+		auto size(mA.size());
+		std::vector<HPS> dmgA(size), dmgB(size);
+
+		computeBatchDamage(mA, mB, dmgA.data(), mKernel);
+		computeBatchDamage(mB, mA, dmgB.data(), mKernel);
+
+		SizeT done{0};
+
+#if GGJ_BATCH_X86
+		if(mKernel == BatchKernel::AVX2) done = Impl::resolveBatchFightsAVX2(mA.hps.data(), dmgA.data(), mB.hps.data(), dmgB.data(), size);
+		else if(mKernel == BatchKernel::SSE41) done = Impl::resolveBatchFightsSSE41(mA.hps.data(), dmgA.data(), mB.hps.data(), dmgB.data(), size);
+#endif
+
+		Impl::resolveBatchFightsScalar(mA.hps.data(), dmgA.data(), mB.hps.data(), dmgB.data(), done, size);
+	}
+}
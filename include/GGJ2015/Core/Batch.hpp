@@ -0,0 +1,74 @@
+#ifndef GGJ2015_CORE_BATCH
+#define GGJ2015_CORE_BATCH
+
+#include "../../GGJ2015/Core/Common.hpp"
+#include "../../GGJ2015/Core/Creature.hpp"
+
+namespace ggj
+{
+	// Structure-of-arrays storage for the combat stats of many creatures (typically one per session),
+	// so that thousands of independent fights can be resolved in lockstep by the batch kernels.
+	// Element bitsets are stored as one byte each.
+	struct CreatureBatch
+	{
+		std::vector<HPS> hps;
+		std::vector<ATK> atk, bonusATK;
+		std::vector<DEF> def, bonusDEF;
+		std::vector<std::uint8_t> strongAgainst, weakAgainst, elementTypes;
+
+		inline SizeT size() const noexcept { return hps.size(); }
+
+		inline void resize(SizeT mSize)
+		{
+			hps.resize(mSize);
+			atk.resize(mSize);
+			bonusATK.resize(mSize);
+			def.resize(mSize);
+			bonusDEF.resize(mSize);
+			strongAgainst.resize(mSize);
+			weakAgainst.resize(mSize);
+			elementTypes.resize(mSize);
+		}
+
+		inline void set(SizeT mIdx, const Creature& mX)
+		{
+			hps[mIdx] = mX.hps;
+			atk[mIdx] = mX.weapon.atk;
+			bonusATK[mIdx] = mX.bonusATK;
+			def[mIdx] = mX.armor.def;
+			bonusDEF[mIdx] = mX.bonusDEF;
+			strongAgainst[mIdx] = mX.weapon.strongAgainst.getBits();
+			weakAgainst[mIdx] = mX.weapon.weakAgainst.getBits();
+			elementTypes[mIdx] = mX.armor.elementTypes.getBits();
+		}
+
+		inline void push(const Creature& mX)
+		{
+			resize(size() + 1);
+			set(size() - 1, mX);
+		}
+	};
+
+	enum class BatchKernel : int
+	{
+		Scalar = 0,
+		SSE41 = 1,
+		AVX2 = 2
+	};
+
+	/// @brief Returns the widest kernel supported by the running CPU.
+	BatchKernel getBestBatchKernel() noexcept;
+
+	const char* getBatchKernelStr(BatchKernel mX) noexcept;
+
+	/// @brief Computes the damage every attacker `i` deals to defender `i`, like `Creature::getDamageAgainst`.
+	/// Stats are assumed to stay below 2^21 in magnitude, where the vector kernels are exact.
+	void computeBatchDamage(const CreatureBatch& mAttackers, const CreatureBatch& mDefenders, HPS* mOut,
+		BatchKernel mKernel = getBestBatchKernel());
+
+	/// @brief Resolves fight `i` between `mA[i]` (attacking first) and `mB[i]` for every `i`, updating both
+	/// HPS arrays exactly like `Creature::fight`. HPS are assumed to stay below 2^23.
+	void resolveBatchFights(CreatureBatch& mA, CreatureBatch& mB, BatchKernel mKernel = getBestBatchKernel());
+}
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef GGJ2015_CORE_BINARYIO
+#define GGJ2015_CORE_BINARYIO
+
+#include <cstring>
+#include "../../GGJ2015/Core/Common.hpp"
+
+namespace ggj
+{
+	namespace Impl
+	{
+		// Fixed-layout binary encoding used by snapshots and replays: integers are little-endian
+		// whatever the host, reals are stored as their IEEE 754 bits.
+		class BinaryWriter
+		{
+			private:
+				std::uint8_t* ptr;
+				std::uint8_t* end;
+
+			public:
+				inline BinaryWriter(std::uint8_t* mBegin, std::uint8_t* mEnd) noexcept : ptr{mBegin}, end{mEnd} { }
+
+				inline std::uint8_t* getPtr() const noexcept { return ptr; }
+
+				template<typename T> inline void putInt(T mX) noexcept
+				{
+					static_assert(std::is_integral<T>{}, "");
+					SSVU_ASSERT(ptr + sizeof(T) <= end);
+
+					auto x(static_cast<std::make_unsigned_t<T>>(mX));
+					for(auto i(0u); i < sizeof(T); ++i) *ptr++ = static_cast<std::uint8_t>(x >> (8 * i));
+				}
+
+				inline void putFloat(float mX) noexcept
+				{
+					std::uint32_t bits;
+					std::memcpy(&bits, &mX, sizeof(bits));
+					putInt(bits);
+				}
+
+				template<typename T> inline void putEnum(T mX) noexcept { putInt(static_cast<std::uint8_t>(mX)); }
+		};
+
+		class BinaryReader
+		{
+			private:
+				const std::uint8_t* ptr;
+				const std::uint8_t* end;
+				bool ok{true};
+
+			public:
+				inline BinaryReader(const std::uint8_t* mBegin, const std::uint8_t* mEnd) noexcept : ptr{mBegin}, end{mEnd} { }
+
+				inline bool isOk() const noexcept { return ok; }
+				inline bool isAtEnd() const noexcept { return ptr == end; }
+				inline void fail() noexcept { ok = false; }
+
+				template<typename T> inline T getInt() noexcept
+				{
+					static_assert(std::is_integral<T>{}, "");
+					if(!ok || end - ptr < static_cast<std::ptrdiff_t>(sizeof(T))) { ok = false; return T{}; }
+
+					std::make_unsigned_t<T> x{0};
+					for(auto i(0u); i < sizeof(T); ++i) x |= static_cast<std::make_unsigned_t<T>>(*ptr++) << (8 * i);
+					return static_cast<T>(x);
+				}
+
+				inline float getFloat() noexcept
+				{
+					auto bits(getInt<std::uint32_t>());
+					float result;
+					std::memcpy(&result, &bits, sizeof(result));
+					return result;
+				}
+
+				/// @brief Reads an enumerator, failing if it is past `mLast`.
+				template<typename T> inline T getEnum(T mLast) noexcept
+				{
+					auto x(getInt<std::uint8_t>());
+					if(x > static_cast<std::uint8_t>(mLast)) { ok = false; return T{}; }
+					return static_cast<T>(x);
+				}
+		};
+	}
+}
+
+#endif
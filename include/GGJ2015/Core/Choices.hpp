@@ -0,0 +1,80 @@
+#ifndef GGJ2015_CORE_CHOICES
+#define GGJ2015_CORE_CHOICES
+
+#include "../../GGJ2015/Core/Common.hpp"
+#include "../../GGJ2015/Core/Creature.hpp"
+#include "../../GGJ2015/Core/Drops.hpp"
+
+namespace ggj
+{
+	struct Choice
+	{
+		enum class Type : int {Advance = 0, Creature = 1, ItemDrop = 2, SingleDrop = 3};
+
+		GameSession& gameSession;
+		SizeT idx;
+		Type type;
+
+		inline Choice(GameSession& mGameState, SizeT mIdx, Type mType) : gameSession{mGameState}, idx{mIdx}, type{mType} { }
+		inline virtual ~Choice() { }
+
+		inline virtual void execute() { }
+
+		inline virtual std::string getChoiceStr() { return ""; }
+	};
+
+	/// @brief Label shown under a choice of type `mX`.
+	inline const char* getChoiceLabel(Choice::Type mX) noexcept
+	{
+		static constexpr const char* labels[]{"Forward", "Fight", "Collect", "Pickup"};
+		return labels[static_cast<int>(mX)];
+	}
+
+	struct ChoiceAdvance : public Choice
+	{
+		inline ChoiceAdvance(GameSession& mGameState, SizeT mIdx) : Choice{mGameState, mIdx, Type::Advance} { }
+
+		void execute() override;
+
+		inline std::string getChoiceStr() override { return getChoiceLabel(Type::Advance); }
+	};
+
+	struct ChoiceCreature : public Choice
+	{
+		Creature creature;
+		ItemDrops drops;	// Left behind when the creature is defeated
+
+		inline ChoiceCreature(GameSession& mGameState, SizeT mIdx) : Choice{mGameState, mIdx, Type::Creature} { }
+
+		void execute() override;
+
+		inline std::string getChoiceStr() override { return getChoiceLabel(Type::Creature); }
+	};
+
+	struct ChoiceItemDrop : public Choice
+	{
+		ItemDrops itemDrops;
+
+		inline ChoiceItemDrop(GameSession& mGS, SizeT mIdx) : Choice{mGS, mIdx, Type::ItemDrop} { }
+
+		void execute() override;
+
+		inline std::string getChoiceStr() override { return getChoiceLabel(Type::ItemDrop); }
+	};
+
+	struct ChoiceSingleDrop : public Choice
+	{
+		DropPtr drop;
+
+		inline ChoiceSingleDrop(GameSession& mGS, SizeT mIdx) : Choice{mGS, mIdx, Type::SingleDrop} { }
+
+		void execute() override;
+
+		inline std::string getChoiceStr() override { return getChoiceLabel(Type::SingleDrop); }
+	};
+
+	using ChoicePool = Pool<Choice, ChoiceAdvance, ChoiceCreature, ChoiceItemDrop, ChoiceSingleDrop>;
+	using ChoicePtr = ChoicePool::Ptr;
+}
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef GGJ2015_CORE_COMMON
+#define GGJ2015_CORE_COMMON
+
+#include <SSVUtils/SSVUtils.hpp>
+
+namespace ggj
+{
+	using SizeT = ssvu::SizeT;
+	template<typename T, typename TD = ssvu::DefDel<T>> using UPtr = ssvu::UPtr<T, TD>;
+	using FT = ssvu::FT;
+}
+
+#endif
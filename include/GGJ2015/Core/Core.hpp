@@ -0,0 +1,26 @@
+#ifndef GGJ2015_CORE_CORE
+#define GGJ2015_CORE_CORE
+
+#include "../../GGJ2015/Core/Common.hpp"
+#include "../../GGJ2015/Core/EventLog.hpp"
+#include "../../GGJ2015/Core/Rng.hpp"
+#include "../../GGJ2015/Core/WeightedTable.hpp"
+#include "../../GGJ2015/Core/Names.hpp"
+#include "../../GGJ2015/Core/Pool.hpp"
+#include "../../GGJ2015/Core/Profiler.hpp"
+#include "../../GGJ2015/Core/SessionObserver.hpp"
+#include "../../GGJ2015/Core/Creature.hpp"
+#include "../../GGJ2015/Core/Gen.hpp"
+#include "../../GGJ2015/Core/Drops.hpp"
+#include "../../GGJ2015/Core/Choices.hpp"
+#include "../../GGJ2015/Core/RoomGenerator.hpp"
+#include "../../GGJ2015/Core/GameSession.hpp"
+#include "../../GGJ2015/Core/Snapshot.hpp"
+#include "../../GGJ2015/Core/Replay.hpp"
+#include "../../GGJ2015/Core/Batch.hpp"
+#include "../../GGJ2015/Core/SessionView.hpp"
+#include "../../GGJ2015/Core/SPSCQueue.hpp"
+#include "../../GGJ2015/Core/TripleBuffer.hpp"
+#include "../../GGJ2015/Core/Worker.hpp"
+
+#endif
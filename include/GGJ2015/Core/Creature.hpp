@@ -0,0 +1,202 @@
+#ifndef GGJ2015_CORE_CREATURE
+#define GGJ2015_CORE_CREATURE
+
+#include "../../GGJ2015/Core/Common.hpp"
+#include "../../GGJ2015/Core/EventLog.hpp"
+#include "../../GGJ2015/Core/Names.hpp"
+#include "../../GGJ2015/Core/Profiler.hpp"
+
+namespace ggj
+{
+	struct GameSession;
+
+	using StatType = std::int32_t;
+	using HPS = StatType;
+	using ATK = StatType;
+	using DEF = StatType;
+
+	struct Constants
+	{
+		static constexpr SizeT elementCount{4};
+		static constexpr SizeT maxChoices{4};
+		static constexpr SizeT maxDrops{3};
+		static constexpr float bonusMultiplier{2.5f};
+		static constexpr float malusMultiplier{0.8f};
+	};
+
+	/// @brief One bit per element, packed in a single byte.
+	struct ElementBitset
+	{
+		static constexpr std::uint8_t mask{(1u << Constants::elementCount) - 1};
+
+		std::uint8_t bits{0};
+
+		inline constexpr ElementBitset() noexcept = default;
+		inline constexpr explicit ElementBitset(unsigned int mBits) noexcept : bits{static_cast<std::uint8_t>(mBits & mask)} { }
+
+		inline constexpr bool operator[](SizeT mI) const noexcept { return ((bits >> mI) & 1u) != 0; }
+		inline void set(SizeT mI) noexcept { SSVU_ASSERT(mI < Constants::elementCount); bits |= 1u << mI; }
+
+		inline constexpr bool any() const noexcept { return bits != 0; }
+		inline constexpr bool none() const noexcept { return bits == 0; }
+		inline constexpr std::uint8_t getBits() const noexcept { return bits; }
+
+		inline constexpr ElementBitset operator&(ElementBitset mX) const noexcept { return ElementBitset(bits & mX.bits); }
+	};
+
+	// Highest element first, like `std::bitset`
+	inline std::ostream& operator<<(std::ostream& mStream, ElementBitset mX)
+	{
+		for(auto i(Constants::elementCount); i > 0; --i) mStream << (mX[i - 1] ? '1' : '0');
+		return mStream;
+	}
+
+	struct Weapon
+	{
+		enum class Type : std::uint8_t {Mace = 0 , Sword = 1, Spear = 2};
+
+		Name name{FixedName::Unarmed};
+		ATK atk{-1};
+		ElementBitset strongAgainst;
+		ElementBitset weakAgainst;
+		Type type{Type::Mace};
+	};
+
+	struct Armor
+	{
+		Name name{FixedName::Unarmored};
+		DEF def{-1};
+		ElementBitset elementTypes;
+	};
+
+	struct FightResult
+	{
+		HPS hps, xHPS;
+	};
+
+	struct Calculations
+	{
+		inline static bool isWeaponStrongAgainst(const Weapon& mW, const Armor& mA)
+		{
+			return (mW.strongAgainst & mA.elementTypes).any();
+		}
+
+		inline static bool isWeaponWeakAgainst(const Weapon& mW, const Armor& mA)
+		{
+			return (mW.weakAgainst & mA.elementTypes).any();
+		}
+
+		// Integer forms of `x *= bonusMultiplier` and `x *= malusMultiplier` on an `int`, which truncate toward zero.
+		// Exact as long as `x * 5` is representable in a float's mantissa, far beyond any reachable stat.
+		static_assert(Constants::bonusMultiplier == 5.f / 2.f, "Integer bonus rounding assumes a 5/2 multiplier");
+		static_assert(Constants::malusMultiplier == 4.f / 5.f, "Integer malus rounding assumes a 4/5 multiplier");
+
+		inline static constexpr int applyBonus(int mX) noexcept { return mX * 5 / 2; }
+		inline static constexpr int applyMalus(int mX) noexcept { return mX * 4 / 5; }
+
+		inline static auto getWeaponDamageAgainst(const Weapon& mW, const Armor& mA, ATK mBonusATK, DEF mBonusDEF)
+		{
+			auto result((mW.atk + mBonusATK) - (mA.def + mBonusDEF));
+			if(isWeaponStrongAgainst(mW, mA)) result = applyBonus(result);
+			if(isWeaponWeakAgainst(mW, mA)) result = applyMalus(result);
+			return ssvu::getClampedMin(result, 0);
+		}
+
+		inline static bool canWeaponDamage(const Weapon& mW, const Armor& mA, ATK mBonusATK, DEF mBonusDEF)
+		{
+			return getWeaponDamageAgainst(mW, mA, mBonusATK, mBonusDEF) > 0;
+		}
+
+		/// @brief Number of hits of `mDmg` needed to bring `mHPS` to zero or less. Returns -1 if it never happens.
+		inline static constexpr int getHitsToKill(HPS mHPS, HPS mDmg) noexcept
+		{
+			return mHPS <= 0 ? 1 : mDmg <= 0 ? -1 : (mHPS + mDmg - 1) / mDmg;
+		}
+
+		/// @brief Resolves a turn-based fight in O(1). The first fighter (`mHPS`, dealing `mDmg`) attacks first,
+		/// then the fighters alternate until one of them is dead. A fight where nobody can deal damage ends
+		/// immediately with no HPS lost.
+		inline static FightResult resolveFight(HPS mHPS, HPS mDmg, HPS mXHPS, HPS mXDmg) noexcept
+		{
+			auto hitsToKillX(getHitsToKill(mXHPS, mDmg));
+			auto hitsToDie(getHitsToKill(mHPS, mXDmg));
+
+			if(hitsToKillX == -1 && hitsToDie == -1) return {mHPS, mXHPS};
+
+			// The first fighter's n-th attack comes before the second fighter's n-th attack
+			if(hitsToDie == -1 || (hitsToKillX != -1 && hitsToKillX <= hitsToDie))
+				return {mHPS - (hitsToKillX - 1) * mXDmg, mXHPS - hitsToKillX * mDmg};
+
+			return {mHPS - hitsToDie * mXDmg, mXHPS - hitsToDie * mDmg};
+		}
+	};
+
+	struct Creature
+	{
+		Name name{FixedName::Unnamed};
+		Weapon weapon;
+		Armor armor;
+		HPS hps{-1};
+
+		ATK bonusATK{0};
+		DEF bonusDEF{0};
+
+		inline void attackOnce(Creature& mX)
+		{
+			mX.hps -= getDamageAgainst(mX);
+		}
+
+		void checkBurns(GameSession& mGameSession);
+
+		inline void fight(Creature& mX)
+		{
+			GGJ_PROFILE_SCOPE(Fight);
+
+			eventLo() << name << " engages " << mX.name << "!\n";
+			auto hpsBefore(hps);
+			auto xHPSBefore(mX.hps);
+
+			auto result(Calculations::resolveFight(hps, getDamageAgainst(mX), mX.hps, mX.getDamageAgainst(*this)));
+			hps = result.hps;
+			mX.hps = result.xHPS;
+
+			if(isDead())
+				eventLo() << mX.name << " wins. HPS " << xHPSBefore << " -> " << mX.hps << "!\n";
+			else
+				eventLo() << name << " wins. HPS " << hpsBefore << " -> " << hps << "!\n";
+		}
+
+		inline HPS getDamageAgainst(const Creature& mX) const noexcept
+		{
+			return Calculations::getWeaponDamageAgainst(weapon, mX.armor, bonusATK, mX.bonusDEF);
+		}
+
+		inline bool canDamage(const Creature& mX) const noexcept
+		{
+			return getDamageAgainst(mX) > 0;
+		}
+
+		inline bool isDead() const noexcept { return hps <= 0; }
+
+		inline std::string getLogStr() const
+		{
+			std::string result;
+
+			result += "HPS: " + ssvu::toStr(hps) + ", ";
+			result += "ATK: " + ssvu::toStr(weapon.atk) + ", ";
+			result += "DEF: " + ssvu::toStr(armor.def) + ", ";
+			result += "Str: " + ssvu::toStr(weapon.strongAgainst) + ", ";
+			result += "Wkk: " + ssvu::toStr(weapon.weakAgainst);
+
+			return result;
+		}
+	};
+
+	// Equipment and creatures are copied on every generation, pickup, fight, snapshot and view: they
+	// must stay plain data, and a whole creature must fit in a cache line.
+	static_assert(std::is_trivially_copyable<Weapon>{} && sizeof(Weapon) == 20, "Weapon must stay plain data");
+	static_assert(std::is_trivially_copyable<Armor>{} && sizeof(Armor) == 20, "Armor must stay plain data");
+	static_assert(std::is_trivially_copyable<Creature>{} && sizeof(Creature) == 64, "Creature must stay plain data");
+}
+
+#endif
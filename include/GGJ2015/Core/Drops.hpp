@@ -0,0 +1,131 @@
+#ifndef GGJ2015_CORE_DROPS
+#define GGJ2015_CORE_DROPS
+
+#include "../../GGJ2015/Core/Common.hpp"
+#include "../../GGJ2015/Core/Creature.hpp"
+#include "../../GGJ2015/Core/Pool.hpp"
+
+namespace ggj
+{
+	struct InstantEffect
+	{
+		enum class Type : int
+		{
+			Add = 0,
+			Sub = 1,
+			Mul = 2,
+			Div = 3
+		};
+
+		enum class Stat : int
+		{
+			SHPS = 0,
+			SATK = 1,
+			SDEF = 2
+		};
+
+		Type type{Type::Add};
+		Stat stat{Stat::SHPS};
+		float value{0.f};
+
+		inline InstantEffect() = default;
+		inline InstantEffect(Type mType, Stat mStat, float mValue) : type{mType}, stat{mStat}, value{mValue} { }
+		void apply(GameSession& mGameSession, Creature& mX);
+
+		inline std::string getStrType() const
+		{
+			static auto array(ssvu::makeArray
+			(
+				"+",
+				"-",
+				"*",
+				"/"
+			));
+
+			return array[static_cast<int>(type)];
+		}
+
+		inline std::string getStrStat() const
+		{
+			static auto array(ssvu::makeArray
+			(
+				"HPS",
+				"ATK",
+				"DEF"
+			));
+
+			return array[static_cast<int>(stat)];
+		}
+	};
+
+	struct Drop
+	{
+		enum class Type : int {Weapon = 0, Armor = 1, IE = 2};
+
+		GameSession& gameSession;
+		Type type;
+
+		inline Drop(GameSession& mGameSession, Type mType) : gameSession{mGameSession}, type{mType} { }
+
+		inline virtual ~Drop() { }
+		inline virtual void apply(Creature&) { }
+	};
+
+	struct WeaponDrop : public Drop
+	{
+		Weapon weapon;
+
+		inline WeaponDrop(GameSession& mGameSession) : Drop{mGameSession, Type::Weapon} { }
+
+		void apply(Creature& mX) override;
+	};
+
+	struct ArmorDrop : public Drop
+	{
+		Armor armor;
+
+		inline ArmorDrop(GameSession& mGameSession) : Drop{mGameSession, Type::Armor} { }
+
+		void apply(Creature& mX) override;
+	};
+
+	struct DropIE : public Drop
+	{
+		// At most two `addIEs` rounds of two effects each
+		static constexpr SizeT maxIEs{4};
+
+		InstantEffect ies[maxIEs];
+		SizeT ieCount{0};
+
+		inline DropIE(GameSession& mGameSession) : Drop{mGameSession, Type::IE} { }
+
+		inline void addIE(InstantEffect mIE)
+		{
+			SSVU_ASSERT(ieCount < maxIEs);
+			ies[ieCount++] = mIE;
+		}
+
+		void apply(Creature& mX) override;
+	};
+
+	using DropPool = Pool<Drop, WeaponDrop, ArmorDrop, DropIE>;
+	using DropPtr = DropPool::Ptr;
+
+	struct ItemDrops
+	{
+		DropPtr drops[Constants::maxDrops];
+
+		inline bool has(int mIdx)
+		{
+			return drops[mIdx] != nullptr;
+		}
+
+		inline void give(int mIdx, Creature& mX)
+		{
+			drops[mIdx]->apply(mX);
+			drops[mIdx].reset();
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef GGJ2015_CORE_EVENTLOG
+#define GGJ2015_CORE_EVENTLOG
+
+#include "../../GGJ2015/Core/Common.hpp"
+#include "../../GGJ2015/Core/Names.hpp"
+
+namespace ggj
+{
+	/// @brief Fixed-capacity ring of log lines. Only the most recent `lineCount` lines are kept,
+	/// and lines longer than `lineLength` are truncated. `getGeneration` changes whenever a line is
+	/// completed, so views can rebuild only when something new was logged.
+	class EventLogBuffer : public std::streambuf
+	{
+		public:
+			static constexpr SizeT lineCount{32};
+			static constexpr SizeT lineLength{80};
+
+		private:
+			char lines[lineCount][lineLength];
+			SizeT lengths[lineCount]{};
+			SizeT current{0};			// Line being written
+			SizeT completed{0};			// Completed lines kept, up to `lineCount - 1`
+			std::uint64_t generation{0};
+
+			inline void put(char mC) noexcept
+			{
+				if(mC != '\n')
+				{
+					if(lengths[current] < lineLength) lines[current][lengths[current]++] = mC;
+					return;
+				}
+
+				current = (current + 1) % lineCount;
+				lengths[current] = 0;
+				if(completed < lineCount - 1) ++completed;
+				++generation;
+			}
+
+		protected:
+			inline int_type overflow(int_type mC) override
+			{
+				if(!traits_type::eq_int_type(mC, traits_type::eof())) put(traits_type::to_char_type(mC));
+				return traits_type::not_eof(mC);
+			}
+
+			inline std::streamsize xsputn(const char* mData, std::streamsize mSize) override
+			{
+				for(auto i(0); i < mSize; ++i) put(mData[i]);
+				return mSize;
+			}
+
+		public:
+			inline std::uint64_t getGeneration() const noexcept { return generation; }
+			inline SizeT getLineCount() const noexcept { return completed; }
+
+			/// @brief Calls `mFn(const char*, SizeT)` for the last `mCount` completed lines, oldest first.
+			template<typename TF> inline void forLastLines(SizeT mCount, const TF& mFn) const
+			{
+				ssvu::clampMax(mCount, completed);
+
+				for(auto i(mCount); i > 0; --i)
+				{
+					auto idx((current + lineCount - i) % lineCount);
+					mFn(lines[idx], lengths[idx]);
+				}
+			}
+
+			inline void clear() noexcept
+			{
+				lengths[current] = 0;
+				completed = 0;
+				++generation;
+			}
+	};
+
+	inline auto& getEventLogBuffer() noexcept { static EventLogBuffer result; return result; }
+	inline auto& getEventLogStream() noexcept { static std::ostream result{&getEventLogBuffer()}; return result; }
+
+	// Headless tools (simulator, benchmarks) disable the log before running sessions.
+	inline auto& getEventLogEnabled() noexcept { static bool result{true}; return result; }
+
+	namespace Impl
+	{
+		struct EventLog
+		{
+			template<typename T> inline auto operator<<(const T& mX)
+			{
+				if(!getEventLogEnabled()) return EventLog{};
+
+				getEventLogStream() << mX;
+				ssvu::lo() << mX;
+				return EventLog{};
+			}
+
+			// Names are rendered straight into both streams instead of through a temporary string.
+			inline auto operator<<(const Name& mX)
+			{
+				if(!getEventLogEnabled()) return EventLog{};
+
+				writeName(getEventLogStream(), mX);
+
+				auto&& out(ssvu::lo());
+				writeName(out, mX);
+				return EventLog{};
+			}
+		};
+	}
+
+	inline auto eventLo() noexcept { return Impl::EventLog{}; }
+}
+
+#endif
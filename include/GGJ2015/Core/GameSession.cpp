@@ -0,0 +1,465 @@
+#include "../../GGJ2015/Core/Core.hpp"
+
+namespace ggj
+{
+	void GameSession::restart()
+	{
+		observer->onStopMusic();
+		observer->onStopSounds();
+
+		// A new run starts with an empty log. Headless sessions, which may run on several threads,
+		// disable the shared log and must leave it alone.
+		if(getEventLogEnabled()) getEventLogBuffer().clear();
+
+		if(mode == Mode::Official || mode == Mode::Beginner) { difficulty = 1.f; difficultyInc = 0.038f; }
+		if(mode == Mode::Hardcore) { difficulty = 1.f; difficultyInc = 0.087f; }
+
+		timerEnabled = (mode != Mode::Beginner);
+
+		state = State::Playing;
+		roomNumber = 0;
+		shake = deathTextTime = 0.f;
+		endDrops();
+		for(auto& c : choices) c.reset();
+		for(auto& c : nextChoices) c.reset();
+
+		discardNextRoom();
+		planNextRoom();
+
+		Weapon startingWeapon;
+		startingWeapon.atk = 5;
+		startingWeapon.name = FixedName::StartingWeapon;
+		player.bonusATK = 1;
+
+		Armor startingArmor;
+		startingArmor.def = 2;
+		startingArmor.name = FixedName::StartingArmor;
+		player.bonusDEF = 1;
+
+		player.name = FixedName::Player;
+		player.hps = 150;
+		player.weapon = startingWeapon;
+		player.armor = startingArmor;
+
+		advance();
+	}
+
+	void GameSession::gotoMenu()
+	{
+		observer->onStopMusic();
+		observer->onStopSounds();
+		shake = deathTextTime = 0.f;
+
+		state = State::Menu;
+
+		currentMusic = MusicID::Menu;
+		refreshMusic();
+		observer->onPrefetchMusic(getLevelMusic(1));
+	}
+
+	void RoomGenerator::generateRndElements(int mL, ElementBitset& mX)
+	{
+		auto d(static_cast<int>(mL * difficulty));
+
+		if(roomNumber < 10) return;
+
+		auto i(0u);
+		auto indices(mkShuffledArray<int>(rng, 0, 1, 2, 3));
+
+		if(rng.getRnd(0, 100) < 50) mX.set(indices[i++]);
+
+		if(d < 20) return;
+		if(rng.getRnd(0, 100) < 45) mX.set(indices[i++]);
+
+		if(d < 30) return;
+		if(rng.getRnd(0, 100) < 40) mX.set(indices[i++]);
+
+		if(d < 40) return;
+		if(rng.getRnd(0, 100) < 35) mX.set(indices[i++]);
+	}
+
+	int RoomGenerator::getRndStat(int mL, float, float)
+	{
+		auto d(static_cast<int>(((mL * 0.8f) + 4) * difficulty));
+
+		return ssvu::getClampedMin(rng.getRnd((int)(d * 0.65f), (int)(d * 1.55f)), 0);
+//		return ssvu::getClampedMin(1, d + ssvu::getRnd(static_cast<int>((mMultMin * d) * rndMultiplier), static_cast<int>((mMultMax * d) * rndMultiplier)));
+	}
+
+	InstantEffect RoomGenerator::generateInstantEffect(InstantEffect::Stat mStat, InstantEffect::Type mType, int mL)
+	{
+		float val(ssvu::getClampedMin((mL / 8) + rng.getRnd(0, 3 + (mL / 12)), 1));
+		if(mStat == InstantEffect::Stat::SHPS) val = mL * (10 + rng.getRnd(-2, 3));
+
+		return {mType, mStat, val};
+	}
+
+	void RoomGenerator::addIEs(int mL, DropIE& dIE)
+	{
+		auto ss(mkShuffledArray<InstantEffect::Stat>
+		(
+			rng,
+			InstantEffect::Stat::SHPS,
+			InstantEffect::Stat::SATK,
+			InstantEffect::Stat::SDEF
+		));
+
+		dIE.addIE(generateInstantEffect(ss[0], InstantEffect::Type::Add, mL));
+		dIE.addIE(generateInstantEffect(ss[1], InstantEffect::Type::Sub, mL));
+	}
+
+	DropPool::PtrT<DropIE> RoomGenerator::generateDropIE(int mL)
+	{
+		auto dIE(dropPool.create<DropIE>(gameSession));
+
+		addIEs(mL, *dIE);
+
+		if(rng.getRnd(0, 100) < ssvu::getClampedMax(mL, 35))
+		{
+			addIEs(mL, *dIE);
+		}
+
+		// if(ssvu::getRnd(0, 100) < 25) dIE->addIE(generateInstantEffect(mL));
+
+		return dIE;
+	}
+
+	DropPool::PtrT<WeaponDrop> RoomGenerator::generateDropWeapon(int mL)
+	{
+		auto dr(dropPool.create<WeaponDrop>(gameSession));
+		dr->weapon = generateWeapon(mL);
+
+		return dr;
+	}
+
+	DropPool::PtrT<ArmorDrop> RoomGenerator::generateDropArmor(int mL)
+	{
+		auto dr(dropPool.create<ArmorDrop>(gameSession));
+		dr->armor = generateArmor(mL);
+
+		return dr;
+	}
+
+	DropPtr RoomGenerator::generateRndDrop(int mL)
+	{
+		switch(getGen().getDropTypes().get(rng))
+		{
+			case Drop::Type::IE: return std::move(generateDropIE(mL));
+			case Drop::Type::Weapon: return std::move(generateDropWeapon(mL));
+			case Drop::Type::Armor: return std::move(generateDropArmor(mL));
+		}
+
+		return nullptr;
+	}
+
+	ItemDrops RoomGenerator::generateDrops(int mL)
+	{
+//		auto d(static_cast<int>(mL * difficultyMultiplier));
+
+		ItemDrops result;
+
+		auto i(0u);
+		result.drops[i] = std::move(generateRndDrop(mL));
+
+		for(; i < Constants::maxDrops; ++i)
+		{
+			if(rng.getRnd(0, 50) > 20) continue;
+
+			result.drops[i] = std::move(generateRndDrop(mL));
+		}
+
+		return result;
+	}
+
+	Weapon RoomGenerator::generateWeapon(int mL)
+	{
+		auto d(static_cast<int>(mL * difficulty));
+
+		Weapon result;
+
+		result.name = Name::mkGenerated(d);
+		result.atk = getRndStat(mL, 0.5f, 1.8f) + 1;
+		generateRndElements(mL, result.strongAgainst);
+		generateRndElements(mL, result.weakAgainst);
+		result.type = static_cast<Weapon::Type>(rng.getRnd(0, 3));
+
+		return result;
+	}
+
+	Armor RoomGenerator::generateArmor(int mL)
+	{
+		auto d(static_cast<int>(mL * difficulty));
+
+		Armor result;
+
+		result.name = Name::mkGenerated(d);
+		result.def = getRndStat(mL, 0.5f, 1.8f) * 0.7f;
+		generateRndElements(mL, result.elementTypes);
+
+		return result;
+	}
+
+	Creature RoomGenerator::generateCreature(int mL)
+	{
+		auto d(static_cast<int>(mL * difficulty));
+
+		Creature result;
+
+		result.name = getGen().generateCreatureName(rng);
+		result.armor = generateArmor(ssvu::getClampedMin(mL * 0.69f + difficulty - 1, 1));
+		result.weapon = generateWeapon(mL - 1);
+		result.hps = d * 5 + rng.getRnd(0, d * 3);
+
+		return result;
+	}
+
+	ChoicePtr RoomGenerator::generateChoiceCreature(int mIdx, int mL)
+	{
+		auto choice(choicePool.create<ChoiceCreature>(gameSession, mIdx));
+		choice->creature = generateCreature((mL + difficulty + (roomNumber / 10)) * difficulty);
+		choice->drops = generateDrops(roomNumber);
+		return std::move(choice);
+	}
+
+	ChoicePtr RoomGenerator::generateChoiceSingleDrop(int mIdx, int mL)
+	{
+		auto choice(choicePool.create<ChoiceSingleDrop>(gameSession, mIdx));
+		choice->drop = generateRndDrop(mL);
+		return std::move(choice);
+	}
+
+	ChoicePtr RoomGenerator::generateChoiceMultipleDrop(int mIdx, int mL)
+	{
+		auto choice(choicePool.create<ChoiceItemDrop>(gameSession, mIdx));
+		choice->itemDrops = generateDrops(mL);
+		return std::move(choice);
+	}
+
+	void RoomGenerator::generateChoices()
+	{
+		GGJ_PROFILE_SCOPE(GenerateChoices);
+
+		auto choiceNumber(2);
+
+		if(roomNumber > 10) choiceNumber = 3;
+		else if(roomNumber > 20) choiceNumber = 4;
+
+		auto indices(mkShuffledArray<int>(rng, 0, 1, 2, 3));
+
+		for(auto& c : choices) c.reset();
+
+		for(int i{0}; i < choiceNumber; ++i)
+		{
+			auto idx(indices[i]);
+
+			switch(getGen().getChoiceTypes().get(rng))
+			{
+				case Choice::Type::Creature: choices[idx] = generateChoiceCreature(idx, roomNumber); break;
+				case Choice::Type::SingleDrop: choices[idx] = generateChoiceSingleDrop(idx, roomNumber); break;
+				case Choice::Type::ItemDrop: choices[idx] = generateChoiceMultipleDrop(idx, roomNumber); break;
+				default: break;
+			}
+		}
+	}
+
+	void GameSession::advance()
+	{
+		GGJ_PROFILE_SCOPE(Advance);
+
+		++roomNumber;
+
+		currentMusic = getLevelMusic(roomNumber);
+		refreshMusic();
+		observer->onPrefetchMusic(getLevelMusic(roomNumber + musicPrefetchRooms));
+
+		if(roomNumber % 5 == 0)
+		{
+			eventLo() << "Increasing difficulty...\n";
+			difficulty += difficultyInc;
+		}
+
+		auto& gen(getNextRoomGen());
+		SSVU_ASSERT(gen.roomNumber == roomNumber);
+
+		if(preparer.isPending()) preparer.wait();
+		else gen.generateChoices();
+
+		// Recycles the previous room's choices. This may destroy the `ChoiceAdvance` currently
+		// executing: `ChoiceAdvance::execute` must not touch its members after calling `advance`.
+		endDrops();
+		for(auto& c : nextChoices) c.reset();
+		for(auto i(0u); i < Constants::maxChoices; ++i) choices[i] = std::move(gen.choices[i]);
+
+		currentRoomGen = 1 - currentRoomGen;
+		resetTimer();
+
+		// The previous room's generator is now empty: the room after this one goes there
+		planNextRoom();
+		if(pregenerate) prepareNextRoom();
+	}
+
+	void GameSession::planNextRoom()
+	{
+		auto next(roomNumber + 1);
+		getNextRoomGen().plan(rng(), next, next % 5 == 0 ? difficulty + difficultyInc : difficulty);
+	}
+
+	void GameSession::prepareNextRoom()
+	{
+		preparer.start([](void* mGen){ static_cast<RoomGenerator*>(mGen)->generateChoices(); }, &getNextRoomGen());
+	}
+
+	void GameSession::discardNextRoom()
+	{
+		preparer.wait();
+		for(auto& c : getNextRoomGen().choices) c.reset();
+	}
+
+	void GameSession::die()
+	{
+		observer->onStopMusic();
+		observer->onPrefetchMusic(getLevelMusic(1));
+		observer->onPlaySound(SoundID::Lose);
+		shake = 250;
+		deathTextTime = 255;
+		state = GameSession::State::Dead;
+	}
+
+	void GameSession::executeChoice(int mI)
+	{
+		if(currentDrops == nullptr)
+		{
+			if(choices[mI] == nullptr) return;
+
+			choices[mI]->execute();
+
+			if(currentDrops == nullptr)
+				refreshChoices();
+		}
+		else
+		{
+			if(mI == 0)
+			{
+				endDrops();
+				refreshChoices();
+			}
+			else
+			{
+				tryPickupDrop(mI - 1);
+			}
+		}
+	}
+
+	void ChoiceAdvance::execute()
+	{
+		gameSession.advance();
+	}
+
+	void ChoiceItemDrop::execute()
+	{
+		gameSession.observer->onPlaySound(SoundID::Grab);
+		gameSession.startDrops(&itemDrops);
+		gameSession.resetChoiceAt(idx, gameSession.getRoomGen().choicePool.create<ChoiceAdvance>(gameSession, idx));
+	}
+
+	void ChoiceSingleDrop::execute()
+	{
+		if(drop == nullptr) return;
+
+		drop->apply(gameSession.player);
+		gameSession.resetChoiceAt(idx, gameSession.getRoomGen().choicePool.create<ChoiceAdvance>(gameSession, idx));
+	}
+
+	void ChoiceCreature::execute()
+	{
+		gameSession.observer->onPlayAttack(gameSession.player.weapon);
+
+		if(gameSession.player.canDamage(creature))
+		{
+			gameSession.player.fight(creature);
+
+			gameSession.sustain();
+
+			gameSession.observer->onPlaySound(SoundID::Drop);
+
+			auto choice(gameSession.getRoomGen().choicePool.create<ChoiceItemDrop>(gameSession, idx));
+			choice->itemDrops = std::move(drops);
+			gameSession.resetChoiceAt(idx, std::move(choice));
+
+			gameSession.shake = 10;
+		}
+		else
+		{
+			eventLo() << gameSession.player.name << " cannot fight " << creature.name << "!\n";
+		}
+	}
+
+	void WeaponDrop::apply(Creature& mX)
+	{
+		gameSession.observer->onPlaySound(SoundID::EquipWpn);
+		mX.weapon = weapon;
+	}
+
+	void ArmorDrop::apply(Creature& mX)
+	{
+		gameSession.observer->onPlaySound(SoundID::EquipArmor);
+		mX.armor = armor;
+	}
+
+	void DropIE::apply(Creature& mX)
+	{
+		gameSession.observer->onPlaySound(SoundID::Powerup);
+		for(auto i(0u); i < ieCount; ++i) ies[i].apply(gameSession, mX);
+	}
+
+	void InstantEffect::apply(GameSession& mGameSession, Creature& mX)
+	{
+		StatType* statPtr{nullptr};
+
+		switch(stat)
+		{
+			case Stat::SHPS: statPtr = &mX.hps; break;
+			case Stat::SATK: statPtr = &mX.bonusATK; break;
+			case Stat::SDEF: statPtr = &mX.bonusDEF; break;
+		}
+
+		float x(static_cast<float>(*statPtr));
+
+		switch(type)
+		{
+			case Type::Add: *statPtr += value; break;
+			case Type::Sub: *statPtr -= value; break;
+			case Type::Mul: *statPtr = static_cast<int>(x * value); break;
+			case Type::Div: *statPtr = static_cast<int>(x / value); break;
+		}
+
+		eventLo() << "Got " << getStrType() << ssvu::toStr(static_cast<int>(value)) << " " << getStrStat() << "!\n";
+
+		mX.checkBurns(mGameSession);
+	}
+
+	void Creature::checkBurns(GameSession& mGameSession)
+	{
+		int burn{0};
+
+		if(bonusATK < 0)
+		{
+			burn -= bonusATK;
+			bonusATK = 0;
+		}
+
+		if(bonusDEF < 0)
+		{
+			burn -= bonusDEF;
+			bonusDEF = 0;
+		}
+
+		if(burn == 0) return;
+
+		auto x(burn * (4 * mGameSession.roomNumber * mGameSession.difficulty));
+
+		hps -= x;
+		eventLo() << name << " suffers " << x << " stat burn dmg!\n";
+		mGameSession.observer->onStatBurn(*this, x);
+	}
+}
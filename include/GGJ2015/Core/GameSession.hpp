@@ -0,0 +1,171 @@
+#ifndef GGJ2015_CORE_GAMESESSION
+#define GGJ2015_CORE_GAMESESSION
+
+#include "../../GGJ2015/Core/Common.hpp"
+#include "../../GGJ2015/Core/EventLog.hpp"
+#include "../../GGJ2015/Core/Rng.hpp"
+#include "../../GGJ2015/Core/SessionObserver.hpp"
+#include "../../GGJ2015/Core/Creature.hpp"
+#include "../../GGJ2015/Core/Gen.hpp"
+#include "../../GGJ2015/Core/Drops.hpp"
+#include "../../GGJ2015/Core/Choices.hpp"
+#include "../../GGJ2015/Core/RoomGenerator.hpp"
+#include "../../GGJ2015/Core/Worker.hpp"
+
+namespace ggj
+{
+	struct GameSession
+	{
+		enum class State : int{Playing = 0, Dead = 1, Menu = 2};
+		enum class Mode : int{Beginner = 0, Official = 1, Hardcore = 2};
+
+		State state{State::Menu};
+		int roomNumber{0};
+		Creature player;
+
+		// Rooms alternate between two generators, which also own the pools recycling their choices
+		// and drops: while a room is played, the next one can be generated by the other generator.
+		// The generators are declared before anything holding their pointers, so they are destroyed last.
+		RoomGenerator roomGens[2]{{*this}, {*this}};
+		SizeT currentRoomGen{0};
+
+		ChoicePtr choices[Constants::maxChoices];
+		ChoicePtr nextChoices[Constants::maxChoices];
+		float timer;
+		float difficulty{1.f};
+		float rndMultiplier{1.2f};
+
+		MusicID currentMusic{MusicID::Menu};
+		SessionObserver* observer{&getNullSessionObserver()};
+
+		ItemDrops* currentDrops{nullptr};
+
+		float shake{0}, deathTextTime{0};
+		float difficultyInc{0.03f};
+
+		Mode mode{Mode::Official};
+		bool timerEnabled{true};
+
+		// Gameplay randomness (generation) and cosmetic randomness (shake, hover animations) use
+		// separate streams, so that presentation never perturbs the outcome of a seeded run.
+		// Each room is generated from its own engine, seeded with one draw of `rng`.
+		Rng rng;
+		Rng cosmeticRng{rng.getFork()};
+
+		// Generates the next room on a worker thread as soon as the current one is entered.
+		// Rooms are planned identically either way: this only changes when the work happens.
+		bool pregenerate{false};
+
+		// Persistent worker of `prepareNextRoom`, whose thread is only created if `pregenerate` is set.
+		// Declared last: a pending generation is finished before anything else is destroyed.
+		Worker preparer;
+
+		inline GameSession() { gotoMenu(); }
+		inline GameSession(SessionObserver& mObserver) : observer{&mObserver} { gotoMenu(); }
+
+		inline void sustain()
+		{
+			if(player.isDead()) return;
+
+			float x(1.f + (roomNumber * 1.5f / difficulty));
+			ssvu::clampMax(x, 20);
+
+			eventLo() << "You drain " << static_cast<int>(x) << " HPS defeating the enemy\n";
+			player.hps += x;
+		}
+
+		inline void seed(std::uint64_t mSeed) noexcept
+		{
+			rng.seed(mSeed);
+			cosmeticRng = rng.getFork();
+		}
+
+		void restart();
+		void gotoMenu();
+
+		inline void tryPickupDrop(int mIdx)
+		{
+			if(!currentDrops->has(mIdx)) return;
+
+			currentDrops->give(mIdx, player);
+		}
+
+		inline void startDrops(ItemDrops* mID)
+		{
+			currentDrops = mID;
+		}
+		inline void endDrops()
+		{
+			currentDrops = nullptr;
+		}
+
+		inline void refreshChoices()
+		{
+			for(auto i(0u); i < Constants::maxChoices; ++i)
+			{
+				if(nextChoices[i] == nullptr) continue;
+				choices[i] = std::move(nextChoices[i]);
+				nextChoices[i] = nullptr;
+			}
+		}
+
+		inline void resetTimer()
+		{
+			if(mode == Mode::Official || mode == Mode::Beginner) timer = ssvu::getSecondsToFT(10);
+			else if(mode == Mode::Hardcore) timer = ssvu::getSecondsToFT(6);
+		}
+
+		/// @brief Runs the room timer down by `mFT`. The run ends when it expires or the player is dead.
+		inline void updateTimer(FT mFT)
+		{
+			if(state != State::Playing) return;
+
+			if(timerEnabled) timer -= mFT;
+			if(timer <= 0 || player.isDead()) die();
+		}
+
+		/// @brief Generator of the room being played: in-room choices come from its pools.
+		inline auto& getRoomGen() noexcept { return roomGens[currentRoomGen]; }
+
+		/// @brief Generator of the next room, planned when the current one is entered.
+		inline auto& getNextRoomGen() noexcept { return roomGens[1 - currentRoomGen]; }
+
+		/// @brief Seeds the next room's generator and sets its room number and difficulty.
+		void planNextRoom();
+
+		/// @brief Starts generating the planned room on a worker thread.
+		void prepareNextRoom();
+
+		/// @brief Waits for a pending generation and recycles the planned room's choices.
+		void discardNextRoom();
+
+		// Level tracks change every 10 rooms; the next one is prefetched this many rooms ahead
+		static constexpr int musicPrefetchRooms{2};
+
+		inline static MusicID getLevelMusic(int mRoom) noexcept
+		{
+			if(mRoom < 10) return MusicID::Lvl1;
+			if(mRoom < 20) return MusicID::Lvl2;
+			if(mRoom < 30) return MusicID::Lvl3;
+			return MusicID::Lvl4;
+		}
+
+		inline void refreshMusic()
+		{
+			observer->onRefreshMusic(currentMusic);
+		}
+
+		template<typename T> inline void resetChoiceAt(SizeT mIdx, T&& mX)
+		{
+			nextChoices[mIdx] = ssvu::fwd<T>(mX);
+		}
+
+		void advance();
+		void die();
+
+		/// @brief Executes the choice (or drop pickup, if the drops modal is open) bound to key `mI`.
+		void executeChoice(int mI);
+	};
+}
+
+#endif
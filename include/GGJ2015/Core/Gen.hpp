@@ -0,0 +1,70 @@
+#ifndef GGJ2015_CORE_GEN
+#define GGJ2015_CORE_GEN
+
+#include "../../GGJ2015/Core/Common.hpp"
+#include "../../GGJ2015/Core/Rng.hpp"
+#include "../../GGJ2015/Core/WeightedTable.hpp"
+#include "../../GGJ2015/Core/Names.hpp"
+#include "../../GGJ2015/Core/Choices.hpp"
+
+namespace ggj
+{
+	namespace Impl
+	{
+		// TODO: ?
+		struct Gen : public NameTables
+		{
+			inline const auto& getChoiceTypes()
+			{
+				// Same odds as the former `getRnd(0, 100) > 15` and nested `getRnd(0, 100) > 20` branches
+				static constexpr WeightedEntry<Choice::Type> data[]
+				{
+					{84.f * 100.f,	Choice::Type::Creature},
+					{16.f * 79.f,	Choice::Type::SingleDrop},
+					{16.f * 21.f,	Choice::Type::ItemDrop},
+				};
+
+				static constexpr auto result(mkWeightedTable(data));
+				return result;
+			}
+
+			inline const auto& getDropTypes()
+			{
+				// Same odds as the former `getRnd(0, 50) > 21` and nested `getRnd(0, 50) > 19` branches
+				static constexpr WeightedEntry<Drop::Type> data[]
+				{
+					{28.f * 50.f,	Drop::Type::IE},
+					{22.f * 30.f,	Drop::Type::Weapon},
+					{22.f * 20.f,	Drop::Type::Armor},
+				};
+
+				static constexpr auto result(mkWeightedTable(data));
+				return result;
+			}
+
+			template<typename T> inline void whileChance(Rng& mRng, int mChance, const T& mFn)
+			{
+				while(mRng.getRnd(0, 100) < mChance)
+				{
+					mFn();
+					mChance /= 2;
+					if(mChance < 2) mChance = 2;
+				}
+			}
+
+			inline auto generateCreatureName(Rng& mRng)
+			{
+				Name result{Name::Kind::Creature};
+
+				whileChance(mRng, 25, [&mRng, &result]{ result.addModifier(getCreatureModifier().getIdx(mRng)); });
+				result.base = getCreatures().getIdx(mRng);
+
+				return result;
+			}
+		};
+	}
+
+	inline auto& getGen() noexcept { static Impl::Gen result; return result; }
+}
+
+#endif
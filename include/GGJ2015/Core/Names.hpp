@@ -0,0 +1,197 @@
+#ifndef GGJ2015_CORE_NAMES
+#define GGJ2015_CORE_NAMES
+
+#include "../../GGJ2015/Core/Common.hpp"
+#include "../../GGJ2015/Core/WeightedTable.hpp"
+
+namespace ggj
+{
+	namespace Impl
+	{
+		using NameGenData = WeightedEntry<const char*>;
+
+		struct NameTables
+		{
+			inline static const auto& getWeapons()
+			{
+				static constexpr NameGenData data[]
+				{
+					{1.0f,		"Sword"},
+					{1.0f,		"Spear"},
+					{1.0f,		"Staff"},
+					{1.0f,		"Gauntlet"},
+					{1.0f,		"Wand"},
+					{0.8f,		"Greatsword"},
+					{0.8f,		"Claymore"},
+					{0.7f,		"Magical sword"},
+					{0.7f,		"Enchanted gauntlets"},
+					{0.5f,		"Greatstaff"},
+				};
+
+				static constexpr auto result(mkWeightedTable(data));
+				return result;
+			}
+
+			inline static const auto& getItemModifiers()
+			{
+				static constexpr NameGenData data[]
+				{
+					{1.0f,		"Rusty"},
+					{1.0f,		"Damaged"},
+					{1.0f,		"Dented"},
+					{1.0f,		"Regular"},
+					{0.8f,		"Powerful"},
+					{0.8f,		"Intense"},
+					{0.8f,		"Heavy"},
+					{0.7f,		"Incredible"},
+					{0.7f,		"Excellent"},
+					{0.5f,		"Supreme"},
+				};
+
+				static constexpr auto result(mkWeightedTable(data));
+				return result;
+			}
+
+			inline static const auto& getCreatures()
+			{
+				static constexpr NameGenData data[]
+				{
+					{1.0f,		"Slime"},
+					{1.0f,		"Skeleton"},
+					{1.0f,		"Dragonkin"},
+					{1.0f,		"Giant crab"},
+					{0.8f,		"Undead"},
+					{0.8f,		"Zombie"},
+					{0.8f,		"Dragon"},
+					{0.7f,		"Ghost"},
+					{0.7f,		"Bloodkin"},
+					{0.5f,		"Scolarship"},
+				};
+
+				static constexpr auto result(mkWeightedTable(data));
+				return result;
+			}
+
+			inline static const auto& getCreatureModifier()
+			{
+				static constexpr NameGenData data[]
+				{
+					{1.0f,		"Injured"},
+					{1.0f,		"Diseased"},
+					{1.0f,		"Enraged"},
+					{1.0f,		"Powerful"},
+					{0.8f,		"Undead"},
+					{0.8f,		"Magical"},
+					{0.8f,		"Enchanted"},
+					{0.7f,		"Phantasm"},
+					{0.7f,		"Bloodthirsty"},
+					{0.5f,		"Ravaging"},
+				};
+
+				static constexpr auto result(mkWeightedTable(data));
+				return result;
+			}
+
+			inline static const auto& getFixedNames()
+			{
+				static auto array(ssvu::makeArray
+				(
+					"Unnamed",
+					"Unarmed",
+					"Unarmored",
+					"Player",
+					"Starting weapon",
+					"Starting armor"
+				));
+
+				return array;
+			}
+		};
+	}
+
+	enum class FixedName : std::uint8_t
+	{
+		Unnamed = 0,
+		Unarmed = 1,
+		Unarmored = 2,
+		Player = 3,
+		StartingWeapon = 4,
+		StartingArmor = 5
+	};
+
+	// Interned name: indices into the static name tables, rendered to text only when displayed or logged.
+	struct Name
+	{
+		enum class Kind : std::uint8_t
+		{
+			Fixed = 0,		// `base` indexes `getFixedNames()`
+			Creature = 1,	// `base` indexes `getCreatures()`, modifiers index `getCreatureModifier()`
+			Generated = 2	// Generated equipment, only `level` is meaningful
+		};
+
+		static constexpr SizeT maxModifiers{8};
+
+		std::uint32_t modifiers{0};		// Up to `maxModifiers` 4-bit table indices
+		std::int32_t level{0};
+		std::uint8_t base{0};
+		Kind kind{Kind::Fixed};
+		std::uint8_t modifierCount{0};
+
+		inline constexpr Name() noexcept = default;
+		inline constexpr Name(Kind mKind) noexcept : kind{mKind} { }
+		inline constexpr Name(FixedName mX) noexcept : base{static_cast<std::uint8_t>(mX)}, kind{Kind::Fixed} { }
+
+		inline static constexpr Name mkGenerated(int mLevel) noexcept
+		{
+			Name result{Kind::Generated};
+			result.level = mLevel;
+			return result;
+		}
+
+		/// @brief Appends a modifier. Modifiers past `maxModifiers` (odds below 1e-12) are dropped.
+		inline void addModifier(SizeT mIdx) noexcept
+		{
+			SSVU_ASSERT(mIdx < 16);
+			if(modifierCount >= maxModifiers) return;
+
+			modifiers |= static_cast<std::uint32_t>(mIdx) << (4 * modifierCount);
+			++modifierCount;
+		}
+
+		inline SizeT getModifier(SizeT mI) const noexcept { return (modifiers >> (4 * mI)) & 0xF; }
+	};
+
+	static_assert(std::is_trivially_copyable<Name>{} && sizeof(Name) == 12, "Name must stay plain data");
+
+	template<typename TStream> inline void writeName(TStream& mStream, const Name& mX)
+	{
+		using NT = Impl::NameTables;
+
+		switch(mX.kind)
+		{
+			case Name::Kind::Fixed:
+				mStream << NT::getFixedNames()[mX.base];
+				break;
+
+			case Name::Kind::Creature:
+				for(auto i(0u); i < mX.modifierCount; ++i) mStream << NT::getCreatureModifier().values[mX.getModifier(i)] << " ";
+				mStream << NT::getCreatures().values[mX.base];
+				break;
+
+			case Name::Kind::Generated:
+				mStream << "Generated name TODO (lvl: " << mX.level << ")";
+				break;
+		}
+	}
+
+	inline std::ostream& operator<<(std::ostream& mStream, const Name& mX) { writeName(mStream, mX); return mStream; }
+
+	inline std::string getNameStr(const Name& mX)
+	{
+		std::ostringstream result;
+		writeName(result, mX);
+		return result.str();
+	}
+}
+
+#endif
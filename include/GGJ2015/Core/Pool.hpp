@@ -0,0 +1,115 @@
+#ifndef GGJ2015_CORE_POOL
+#define GGJ2015_CORE_POOL
+
+#include "../../GGJ2015/Core/Common.hpp"
+
+namespace ggj
+{
+	namespace Impl
+	{
+		template<typename... Ts> inline constexpr SizeT getMaxSizeOf() noexcept
+		{
+			SizeT result{0}, sizes[]{sizeof(Ts)...};
+			for(auto s : sizes) if(s > result) result = s;
+			return result;
+		}
+
+		template<typename... Ts> inline constexpr SizeT getMaxAlignOf() noexcept
+		{
+			SizeT result{1}, aligns[]{alignof(Ts)...};
+			for(auto a : aligns) if(a > result) result = a;
+			return result;
+		}
+	}
+
+	/// @brief Recycling storage for a polymorphic hierarchy rooted at `TBase`, with slots sized for the
+	/// largest of `TTypes`. Objects are handed out as `UPtr`s whose deleter returns the slot to the
+	/// free list, so replacing or resetting a pointer recycles its object. Slots are allocated in
+	/// chunks and never freed before the pool itself: once warmed up, the pool does not touch the heap.
+	/// The pool must outlive every pointer it has handed out.
+	template<typename TBase, typename... TTypes> class Pool
+	{
+		public:
+			struct Del
+			{
+				Pool* pool{nullptr};
+
+				inline void operator()(TBase* mX) const noexcept { pool->destroy(mX); }
+			};
+
+			template<typename T> using PtrT = UPtr<T, Del>;
+			using Ptr = PtrT<TBase>;
+
+		private:
+			static constexpr SizeT slotSize{Impl::getMaxSizeOf<TTypes...>()};
+			static constexpr SizeT slotAlign{Impl::getMaxAlignOf<TTypes...>()};
+			static constexpr SizeT chunkSlots{16};
+
+			union Slot
+			{
+				Slot* next;
+				std::aligned_storage_t<slotSize, slotAlign> storage;
+			};
+
+			std::vector<std::unique_ptr<Slot[]>> chunks;
+			Slot* freeList{nullptr};
+			SizeT liveCount{0};
+
+			inline void grow()
+			{
+				chunks.emplace_back(std::make_unique<Slot[]>(chunkSlots));
+				auto* chunk(chunks.back().get());
+
+				for(auto i(0u); i < chunkSlots; ++i)
+				{
+					chunk[i].next = freeList;
+					freeList = &chunk[i];
+				}
+			}
+
+			inline void destroy(TBase* mX) noexcept
+			{
+				mX->~TBase();
+
+				auto* slot(reinterpret_cast<Slot*>(mX));
+				slot->next = freeList;
+				freeList = slot;
+				--liveCount;
+			}
+
+		public:
+			inline Pool() = default;
+
+			inline Pool(const Pool&) = delete;
+			inline Pool& operator=(const Pool&) = delete;
+
+			inline ~Pool() { SSVU_ASSERT(liveCount == 0); }
+
+			template<typename T, typename... TArgs> inline PtrT<T> create(TArgs&&... mArgs)
+			{
+				static_assert(std::is_base_of<TBase, T>{}, "T must derive from the pool's base type");
+				static_assert(sizeof(T) <= slotSize && alignof(T) <= slotAlign, "T is not one of the pool's types");
+
+				if(freeList == nullptr) grow();
+
+				auto* slot(freeList);
+				freeList = slot->next;
+
+				// Construct first: if the constructor throws, the slot is simply not consumed.
+				T* result;
+				try { result = new(&slot->storage) T(ssvu::fwd<TArgs>(mArgs)...); }
+				catch(...) { slot->next = freeList; freeList = slot; throw; }
+
+				++liveCount;
+				return PtrT<T>{result, Del{this}};
+			}
+
+			/// @brief Number of objects currently handed out.
+			inline SizeT getLiveCount() const noexcept { return liveCount; }
+
+			/// @brief Number of slots owned by the pool.
+			inline SizeT getCapacity() const noexcept { return chunks.size() * chunkSlots; }
+	};
+}
+
+#endif
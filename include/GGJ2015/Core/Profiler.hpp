@@ -0,0 +1,153 @@
+#ifndef GGJ2015_CORE_PROFILER
+#define GGJ2015_CORE_PROFILER
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include "../../GGJ2015/Core/Common.hpp"
+
+// Scoped timers are only compiled in with `GGJ2015_PROFILER` defined (CMake option of the same name).
+// Otherwise `GGJ_PROFILE_SCOPE` expands to nothing and the profiler is never touched.
+#if defined(GGJ2015_PROFILER)
+	#define GGJ_PROFILE_SCOPE(mPhase) ::ggj::Profiler::ScopedTimer ggjProfileScope{::ggj::Profiler::Phase::mPhase}
+#else
+	#define GGJ_PROFILE_SCOPE(mPhase) do { } while(false)
+#endif
+
+namespace ggj
+{
+	namespace Profiler
+	{
+		using Clock = std::chrono::steady_clock;
+
+		enum class Phase : int
+		{
+			Frame = 0,				// Whole frame, from one `endFrame` to the next
+			Update = 1,
+			DrawPlaying = 2,
+			Advance = 3,
+			GenerateChoices = 4,
+			Fight = 5,
+			Audio = 6
+		};
+
+		constexpr SizeT phaseCount{7};
+		constexpr SizeT frameCount{240};
+
+		inline const auto& getPhaseStr(Phase mX)
+		{
+			static auto array(ssvu::makeArray
+			(
+				"Frame",
+				"Update",
+				"DrawPlaying",
+				"Advance",
+				"GenerateChoices",
+				"Fight",
+				"Audio"
+			));
+
+			return array[static_cast<int>(mX)];
+		}
+
+		struct PhaseStats
+		{
+			float min{0.f}, avg{0.f}, p99{0.f};		// Milliseconds
+		};
+
+		/// @brief Per-phase time spent in each of the last `frameCount` frames.
+		/// Timers may run on any thread: they add to the current frame's totals with relaxed atomics.
+		/// `endFrame` (main thread) moves the totals into the history rings.
+		class FrameProfiler
+		{
+			private:
+				std::atomic<std::uint64_t> current[phaseCount];		// Nanoseconds in the current frame
+				std::uint32_t history[phaseCount][frameCount]{};	// Microseconds
+				SizeT next{0}, filled{0};
+				Clock::time_point frameStart{Clock::now()};
+
+			public:
+				inline FrameProfiler() { for(auto& c : current) c.store(0, std::memory_order_relaxed); }
+
+				inline void add(Phase mPhase, Clock::duration mX) noexcept
+				{
+					current[static_cast<int>(mPhase)].fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(mX).count(), std::memory_order_relaxed);
+				}
+
+				inline void endFrame() noexcept
+				{
+					auto now(Clock::now());
+					add(Phase::Frame, now - frameStart);
+					frameStart = now;
+
+					for(auto i(0u); i < phaseCount; ++i)
+						history[i][next] = static_cast<std::uint32_t>(current[i].exchange(0, std::memory_order_relaxed) / 1000);
+
+					next = (next + 1) % frameCount;
+					if(filled < frameCount) ++filled;
+				}
+
+				inline SizeT getFrameCount() const noexcept { return filled; }
+
+				/// @brief Calls `mFn(float ms)` for every recorded frame of `mPhase`, oldest first.
+				template<typename TF> inline void forFrames(Phase mPhase, const TF& mFn) const
+				{
+					const auto& h(history[static_cast<int>(mPhase)]);
+					for(auto i(filled); i > 0; --i) mFn(h[(next + frameCount - i) % frameCount] / 1000.f);
+				}
+
+				inline PhaseStats getStats(Phase mPhase) const
+				{
+					PhaseStats result;
+					if(filled == 0) return result;
+
+					std::uint32_t sorted[frameCount];
+					SizeT n{0};
+					forFrames(mPhase, [&sorted, &n](float mX){ sorted[n++] = static_cast<std::uint32_t>(mX * 1000.f + 0.5f); });
+					std::sort(sorted, sorted + n);
+
+					std::uint64_t sum{0};
+					for(auto i(0u); i < n; ++i) sum += sorted[i];
+
+					result.min = sorted[0] / 1000.f;
+					result.avg = sum / 1000.f / n;
+					result.p99 = sorted[(n - 1) * 99 / 100] / 1000.f;
+					return result;
+				}
+
+				/// @brief Writes one row per recorded frame, oldest first, with one column (milliseconds) per phase.
+				inline void dumpCSV(std::ostream& mX) const
+				{
+					mX << "frame";
+					for(auto i(0u); i < phaseCount; ++i) mX << "," << getPhaseStr(static_cast<Phase>(i));
+					mX << "\n";
+
+					for(auto f(0u); f < filled; ++f)
+					{
+						mX << f;
+
+						for(auto i(0u); i < phaseCount; ++i)
+							mX << "," << history[i][(next + frameCount - filled + f) % frameCount] / 1000.f;
+
+						mX << "\n";
+					}
+				}
+		};
+
+		inline auto& getProfiler() noexcept { static FrameProfiler result; return result; }
+
+		struct ScopedTimer
+		{
+			Phase phase;
+			Clock::time_point start{Clock::now()};
+
+			inline ScopedTimer(Phase mPhase) noexcept : phase{mPhase} { }
+			inline ~ScopedTimer() { getProfiler().add(phase, Clock::now() - start); }
+
+			inline ScopedTimer(const ScopedTimer&) = delete;
+			inline ScopedTimer& operator=(const ScopedTimer&) = delete;
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,256 @@
+#include <fstream>
+#include <iterator>
+#include "../../GGJ2015/Core/Core.hpp"
+#include "../../GGJ2015/Core/BinaryIO.hpp"
+
+namespace ggj
+{
+	namespace Impl
+	{
+		// Layout, in order (integers little-endian, reals as IEEE 754 bits):
+		//   header   u32 magic, u16 version, u8 mode, u8 reserved
+		//   run      u64 seed, f32 tickFT, u32 endTick, u32 press count, u32 checksum count
+		//   presses  u32 tick, u8 key
+		//   rooms    u64 checksum
+		constexpr SizeT replayHeaderSize{32};
+		constexpr SizeT replayPressSize{5};
+
+		// 64-bit FNV-1a
+		class Checksum
+		{
+			private:
+				std::uint64_t hash{0xcbf29ce484222325ull};
+
+			public:
+				template<typename T> inline void add(T mX) noexcept
+				{
+					static_assert(std::is_integral<T>{} || std::is_enum<T>{}, "");
+
+					auto x(static_cast<std::uint64_t>(mX));
+					for(auto i(0u); i < sizeof(T); ++i) { hash ^= (x >> (8 * i)) & 0xff; hash *= 0x100000001b3ull; }
+				}
+
+				inline void add(float mX) noexcept
+				{
+					std::uint32_t bits;
+					std::memcpy(&bits, &mX, sizeof(bits));
+					add(bits);
+				}
+
+				inline void add(const Creature& mX) noexcept
+				{
+					add(mX.hps);
+					add(mX.bonusATK);
+					add(mX.bonusDEF);
+					add(mX.weapon.atk);
+
+					// Hashed as 4- and 8-byte values: checksums must not depend on how the fields are stored
+					add(static_cast<int>(mX.weapon.type));
+					add(std::uint64_t{mX.weapon.strongAgainst.getBits()});
+					add(std::uint64_t{mX.weapon.weakAgainst.getBits()});
+					add(mX.armor.def);
+					add(std::uint64_t{mX.armor.elementTypes.getBits()});
+				}
+
+				inline std::uint64_t get() const noexcept { return hash; }
+		};
+	}
+
+	std::uint64_t getChecksum(const GameSession& mGS)
+	{
+		Impl::Checksum cs;
+
+		cs.add(mGS.state);
+		cs.add(mGS.roomNumber);
+		cs.add(mGS.timer);
+		cs.add(mGS.difficulty);
+		for(auto x : mGS.rng.getState()) cs.add(x);
+		cs.add(mGS.player);
+
+		for(const auto& c : mGS.choices)
+		{
+			if(c == nullptr) { cs.add(-1); continue; }
+
+			cs.add(c->type);
+			if(c->type == Choice::Type::Creature) cs.add(static_cast<const ChoiceCreature&>(*c).creature);
+		}
+
+		return cs.get();
+	}
+
+	std::vector<std::uint8_t> RunReplay::writeToBuffer() const
+	{
+		std::vector<std::uint8_t> data(Impl::replayHeaderSize + presses.size() * Impl::replayPressSize + roomChecksums.size() * 8);
+		Impl::BinaryWriter w{data.data(), data.data() + data.size()};
+
+		w.putInt(Replay::magic);
+		w.putInt(Replay::version);
+		w.putEnum(mode);
+		w.putInt(std::uint8_t{0});
+		w.putInt(seed);
+		w.putFloat(tickFT);
+		w.putInt(endTick);
+		w.putInt(static_cast<std::uint32_t>(presses.size()));
+		w.putInt(static_cast<std::uint32_t>(roomChecksums.size()));
+
+		for(const auto& p : presses) { w.putInt(p.tick); w.putInt(p.key); }
+		for(auto c : roomChecksums) w.putInt(c);
+
+		return data;
+	}
+
+	bool RunReplay::readFromBuffer(const std::uint8_t* mData, SizeT mSize)
+	{
+		Impl::BinaryReader r{mData, mData + mSize};
+
+		if(r.getInt<std::uint32_t>() != Replay::magic || r.getInt<std::uint16_t>() != Replay::version) return false;
+
+		mode = r.getEnum(GameSession::Mode::Hardcore);
+		r.getInt<std::uint8_t>();
+		seed = r.getInt<std::uint64_t>();
+		tickFT = r.getFloat();
+		endTick = r.getInt<std::uint32_t>();
+
+		auto pressCount(r.getInt<std::uint32_t>());
+		auto checksumCount(r.getInt<std::uint32_t>());
+		if(!r.isOk() || mSize != Impl::replayHeaderSize + pressCount * Impl::replayPressSize + checksumCount * std::uint64_t{8}) return false;
+
+		presses.resize(pressCount);
+		for(auto& p : presses)
+		{
+			p.tick = r.getInt<std::uint32_t>();
+			p.key = r.getInt<std::uint8_t>();
+			if(p.key >= Constants::maxChoices || (&p != &presses.front() && p.tick < (&p - 1)->tick)) return false;
+		}
+
+		roomChecksums.resize(checksumCount);
+		for(auto& c : roomChecksums) c = r.getInt<std::uint64_t>();
+
+		return r.isOk() && r.isAtEnd();
+	}
+
+	bool RunReplay::writeToFile(const std::string& mPath) const
+	{
+		auto data(writeToBuffer());
+
+		std::ofstream o{mPath, std::ios::binary};
+		o.write(reinterpret_cast<const char*>(data.data()), data.size());
+		return static_cast<bool>(o);
+	}
+
+	bool RunReplay::readFromFile(const std::string& mPath)
+	{
+		std::ifstream i{mPath, std::ios::binary};
+		if(!i) return false;
+
+		std::vector<std::uint8_t> data{std::istreambuf_iterator<char>{i}, std::istreambuf_iterator<char>{}};
+		return readFromBuffer(data.data(), data.size());
+	}
+
+	void ReplayRecorder::begin(GameSession& mGS, GameSession::Mode mMode, std::uint64_t mSeed)
+	{
+		replay = RunReplay{};
+		replay.seed = mSeed;
+		replay.mode = mMode;
+		tick = 0;
+		recording = true;
+
+		mGS.seed(mSeed);
+		mGS.mode = mMode;
+		mGS.restart();
+
+		replay.roomChecksums.emplace_back(getChecksum(mGS));
+	}
+
+	void ReplayRecorder::execute(GameSession& mGS, int mKey)
+	{
+		mGS.executeChoice(mKey);
+		if(!recording) return;
+
+		replay.presses.push_back({tick, static_cast<std::uint8_t>(mKey)});
+
+		// A press enters at most one room
+		if(static_cast<SizeT>(mGS.roomNumber) > replay.roomChecksums.size())
+		{
+			SSVU_ASSERT(static_cast<SizeT>(mGS.roomNumber) == replay.roomChecksums.size() + 1);
+			replay.roomChecksums.emplace_back(getChecksum(mGS));
+		}
+	}
+
+	bool ReplayRecorder::endTick(const GameSession& mGS, FT mFT)
+	{
+		if(!recording) return false;
+
+		if(tick == 0) replay.tickFT = mFT;
+		++tick;
+
+		if(mGS.state == GameSession::State::Playing) return false;
+
+		replay.endTick = tick;
+		recording = false;
+		return true;
+	}
+
+	void ReplayPlayer::checkRoom(const GameSession& mGS)
+	{
+		// Checksums are only compared on entering a room, right after the press, like they were recorded
+		if(mGS.roomNumber == room) return;
+		room = mGS.roomNumber;
+
+		if(divergedRoom != -1) return;
+
+		const auto& checksums(replay->roomChecksums);
+		if(static_cast<SizeT>(room) > checksums.size() || checksums[room - 1] != getChecksum(mGS)) divergedRoom = room;
+	}
+
+	void ReplayPlayer::begin(GameSession& mGS, const RunReplay& mReplay)
+	{
+		replay = &mReplay;
+		nextPress = 0;
+		tick = 0;
+		room = 0;
+		divergedRoom = -1;
+
+		mGS.seed(mReplay.seed);
+		mGS.mode = mReplay.mode;
+		mGS.restart();
+
+		checkRoom(mGS);
+		if(mReplay.endTick == 0) replay = nullptr;
+	}
+
+	void ReplayPlayer::applyPresses(GameSession& mGS)
+	{
+		if(replay == nullptr) return;
+
+		const auto& presses(replay->presses);
+		for(; nextPress < presses.size() && presses[nextPress].tick == tick; ++nextPress)
+		{
+			mGS.executeChoice(presses[nextPress].key);
+			checkRoom(mGS);
+		}
+	}
+
+	void ReplayPlayer::endTick(const GameSession& mGS)
+	{
+		if(replay == nullptr) return;
+
+		++tick;
+		if(tick >= replay->endTick || mGS.state != GameSession::State::Playing) replay = nullptr;
+	}
+
+	ReplayResult playReplay(GameSession& mGS, const RunReplay& mReplay)
+	{
+		ReplayPlayer player;
+		player.begin(mGS, mReplay);
+
+		while(player.isPlaying())
+		{
+			player.applyPresses(mGS);
+			mGS.updateTimer(mReplay.tickFT);
+			player.endTick(mGS);
+		}
+
+		return {mGS.roomNumber, mGS.state, player.getDivergedRoom()};
+	}
+}
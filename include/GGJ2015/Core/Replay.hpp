@@ -0,0 +1,106 @@
+#ifndef GGJ2015_CORE_REPLAY
+#define GGJ2015_CORE_REPLAY
+
+#include "../../GGJ2015/Core/Common.hpp"
+#include "../../GGJ2015/Core/GameSession.hpp"
+
+namespace ggj
+{
+	namespace Replay
+	{
+		constexpr std::uint32_t magic{0x524a4747};		// "GGJR", little-endian
+		constexpr std::uint16_t version{2};
+	}
+
+	struct ReplayPress
+	{
+		std::uint32_t tick;		// Timer steps run before the press
+		std::uint8_t key;		// Choice index, as passed to `GameSession::executeChoice`
+	};
+
+	/// @brief A recorded run, from `restart` to its end: seed, mode and the timestamped choice key
+	/// presses. Time is counted in timer steps (`GameSession::updateTimer` calls), so playback does
+	/// not depend on the frame rate. A checksum of the session is kept for every room entered, taken
+	/// right after the press that entered it.
+	struct RunReplay
+	{
+		std::uint64_t seed{0};
+		GameSession::Mode mode{GameSession::Mode::Official};
+		float tickFT{0.5f};			// Timer step of the recording
+		std::uint32_t endTick{0};
+		std::vector<ReplayPress> presses;
+		std::vector<std::uint64_t> roomChecksums;	// Room `n` at index `n - 1`
+
+		/// @brief Returns the replay in the `.ggjr` format.
+		std::vector<std::uint8_t> writeToBuffer() const;
+
+		/// @brief Replaces the replay with one in the `.ggjr` format. Returns false if `mData` is
+		/// not one or is from another version.
+		bool readFromBuffer(const std::uint8_t* mData, SizeT mSize);
+
+		bool writeToFile(const std::string& mPath) const;
+		bool readFromFile(const std::string& mPath);
+	};
+
+	/// @brief Hash of the gameplay state of a session (cosmetic state excluded).
+	std::uint64_t getChecksum(const GameSession& mGS);
+
+	/// @brief Records a run. Execute every choice key pressed while playing through `execute`, and
+	/// call `endTick` after every timer step; the run ends by itself once the session is no longer playing.
+	class ReplayRecorder
+	{
+		private:
+			RunReplay replay;
+			std::uint32_t tick{0};
+			bool recording{false};
+
+		public:
+			/// @brief Seeds and restarts `mGS` in mode `mMode`, and starts recording.
+			void begin(GameSession& mGS, GameSession::Mode mMode, std::uint64_t mSeed);
+
+			/// @brief Executes choice `mKey` in `mGS` and records it. Any number of presses may
+			/// happen between two timer steps.
+			void execute(GameSession& mGS, int mKey);
+
+			/// @brief Returns true on the step that ends the recording.
+			bool endTick(const GameSession& mGS, FT mFT);
+
+			inline bool isRecording() const noexcept { return recording; }
+			inline const RunReplay& getReplay() const noexcept { return replay; }
+	};
+
+	/// @brief Plays a `RunReplay` back into a session, either driven by the game loop (`applyPresses`
+	/// before and `endTick` after each timer step) or headless at full speed with `playReplay`.
+	class ReplayPlayer
+	{
+		private:
+			const RunReplay* replay{nullptr};
+			SizeT nextPress{0};
+			std::uint32_t tick{0};
+			int room{0}, divergedRoom{-1};
+
+			void checkRoom(const GameSession& mGS);
+
+		public:
+			void begin(GameSession& mGS, const RunReplay& mReplay);
+			void applyPresses(GameSession& mGS);
+			void endTick(const GameSession& mGS);
+
+			inline bool isPlaying() const noexcept { return replay != nullptr; }
+
+			/// @brief First room whose checksum did not match the recording, -1 if none.
+			inline int getDivergedRoom() const noexcept { return divergedRoom; }
+	};
+
+	struct ReplayResult
+	{
+		int room;
+		GameSession::State state;
+		int divergedRoom;
+	};
+
+	/// @brief Plays `mReplay` back into `mGS` as fast as possible, with no frame pacing.
+	ReplayResult playReplay(GameSession& mGS, const RunReplay& mReplay);
+}
+
+#endif
@@ -0,0 +1,161 @@
+#ifndef GGJ2015_CORE_RNG
+#define GGJ2015_CORE_RNG
+
+#include <random>
+#include "../../GGJ2015/Core/Common.hpp"
+
+namespace ggj
+{
+	// Session-owned xoshiro256** engine, so that independent sessions can run on separate threads
+	// and runs can be reproduced from their seed.
+	// Satisfies UniformRandomBitGenerator, but prefer the member samplers: they are unbiased and
+	// much cheaper than `std::uniform_*_distribution`.
+	class Rng
+	{
+		public:
+			using result_type = std::uint64_t;
+			using State = std::array<std::uint64_t, 4>;
+
+		private:
+			State s;
+
+			inline static constexpr std::uint64_t rotl(std::uint64_t mX, int mK) noexcept
+			{
+				return (mX << mK) | (mX >> (64 - mK));
+			}
+
+			inline static std::uint64_t splitMix64(std::uint64_t& mX) noexcept
+			{
+				auto z(mX += 0x9e3779b97f4a7c15ull);
+				z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+				z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+				return z ^ (z >> 31);
+			}
+
+		public:
+			inline static constexpr result_type min() noexcept { return 0; }
+			inline static constexpr result_type max() noexcept { return std::numeric_limits<result_type>::max(); }
+
+			inline Rng() { seed((std::uint64_t{std::random_device{}()} << 32) ^ std::random_device{}()); }
+			inline Rng(std::uint64_t mSeed) { seed(mSeed); }
+
+			inline void seed(std::uint64_t mSeed) noexcept
+			{
+				for(auto& x : s) x = splitMix64(mSeed);
+			}
+
+			inline const auto& getState() const noexcept { return s; }
+			inline void setState(const State& mX) noexcept { s = mX; }
+
+			inline result_type operator()() noexcept
+			{
+				auto result(rotl(s[1] * 5, 7) * 9);
+				auto t(s[1] << 17);
+
+				s[2] ^= s[0];
+				s[3] ^= s[1];
+				s[1] ^= s[2];
+				s[0] ^= s[3];
+				s[2] ^= t;
+				s[3] = rotl(s[3], 45);
+
+				return result;
+			}
+
+			/// @brief Advances the engine by 2^128 draws, giving a non-overlapping stream.
+			inline void jump() noexcept
+			{
+				static constexpr std::uint64_t jumpTable[]{0x180ec6d33cfd0abaull, 0xd5a61266f0c9392cull, 0xa9582618e03fc9aaull, 0x39abdc4529b1661cull};
+
+				State result{{0, 0, 0, 0}};
+
+				for(auto j : jumpTable)
+					for(auto b(0); b < 64; ++b)
+					{
+						if(j & (std::uint64_t{1} << b))
+							for(auto i(0u); i < result.size(); ++i) result[i] ^= s[i];
+
+						(*this)();
+					}
+
+				s = result;
+			}
+
+			/// @brief Returns a copy of the engine advanced to a non-overlapping stream.
+			inline Rng getFork() const noexcept
+			{
+				auto result(*this);
+				result.jump();
+				return result;
+			}
+
+			/// @brief Returns an unbiased integer in [0, mRange) (Lemire's multiply-shift with rejection).
+			inline std::uint32_t getBounded(std::uint32_t mRange) noexcept
+			{
+				auto m(std::uint64_t{static_cast<std::uint32_t>((*this)() >> 32)} * mRange);
+				auto l(static_cast<std::uint32_t>(m));
+
+				if(l < mRange)
+				{
+					auto t((0u - mRange) % mRange);
+					while(l < t)
+					{
+						m = std::uint64_t{static_cast<std::uint32_t>((*this)() >> 32)} * mRange;
+						l = static_cast<std::uint32_t>(m);
+					}
+				}
+
+				return static_cast<std::uint32_t>(m >> 32);
+			}
+
+			/// @brief Returns a random integer in [mMin, mMax).
+			template<typename T1, typename T2> inline auto getRnd(const T1& mMin, const T2& mMax) noexcept
+			{
+				using CT = std::common_type_t<T1, T2>;
+				static_assert(std::is_integral<CT>{}, "getRnd requires integral bounds - use getRndR for reals");
+				SSVU_ASSERT(mMin < mMax);
+
+				auto range(static_cast<std::uint64_t>(static_cast<CT>(mMax) - static_cast<CT>(mMin)));
+				SSVU_ASSERT(range <= std::numeric_limits<std::uint32_t>::max());
+
+				return static_cast<CT>(mMin + static_cast<CT>(getBounded(static_cast<std::uint32_t>(range))));
+			}
+
+			/// @brief Returns a random real in [0, 1), using as many random bits as the mantissa holds.
+			template<typename T> inline T getUnit() noexcept
+			{
+				constexpr auto bits(std::numeric_limits<T>::digits);
+				return static_cast<T>((*this)() >> (64 - bits)) * (T(1) / static_cast<T>(std::uint64_t{1} << bits));
+			}
+
+			/// @brief Returns a random real in [mMin, mMax).
+			template<typename T1, typename T2> inline auto getRndR(const T1& mMin, const T2& mMax) noexcept
+			{
+				using CT = std::common_type_t<T1, T2>;
+				static_assert(std::is_floating_point<CT>{}, "getRndR requires real bounds - use getRnd for integers");
+				SSVU_ASSERT(mMin < mMax);
+
+				return static_cast<CT>(mMin) + getUnit<CT>() * (static_cast<CT>(mMax) - static_cast<CT>(mMin));
+			}
+
+			/// @brief Fisher-Yates shuffle.
+			template<typename T> inline void shuffle(T& mX) noexcept
+			{
+				using std::swap;
+
+				auto first(std::begin(mX));
+				auto size(static_cast<std::uint32_t>(std::distance(first, std::end(mX))));
+
+				for(auto i(size); i > 1; --i) swap(first[i - 1], first[getBounded(i)]);
+			}
+	};
+
+	template<typename T, typename... TArgs> inline auto mkShuffledArray(Rng& mRng, TArgs&&... mArgs)
+	{
+		std::array<T, sizeof...(TArgs)> result{{static_cast<T>(ssvu::fwd<TArgs>(mArgs))...}};
+		mRng.shuffle(result);
+		return result;
+	}
+}
+
+#endif
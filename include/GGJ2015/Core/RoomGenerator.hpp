@@ -0,0 +1,66 @@
+#ifndef GGJ2015_CORE_ROOMGENERATOR
+#define GGJ2015_CORE_ROOMGENERATOR
+
+#include "../../GGJ2015/Core/Common.hpp"
+#include "../../GGJ2015/Core/Rng.hpp"
+#include "../../GGJ2015/Core/Creature.hpp"
+#include "../../GGJ2015/Core/Drops.hpp"
+#include "../../GGJ2015/Core/Choices.hpp"
+
+namespace ggj
+{
+	struct GameSession;
+
+	/// @brief Generates the choices of one room, with its own random engine and pools.
+	/// Everything a room needs is generated up front (including the drops of its creatures), so
+	/// generation never depends on what the player does in the room, and a generator only touches
+	/// its own members: a session can run it on a worker thread while another room is played.
+	struct RoomGenerator
+	{
+		GameSession& gameSession;	// Only handed to the generated choices and drops
+		Rng rng{0};
+		std::uint64_t seed{0};		// Seed of `rng` when the room was planned
+		int roomNumber{0};
+		float difficulty{1.f};
+
+		// Pools are declared before the choices holding their pointers, so they are destroyed last
+		DropPool dropPool;
+		ChoicePool choicePool;
+		ChoicePtr choices[Constants::maxChoices];
+
+		inline RoomGenerator(GameSession& mGameSession) : gameSession{mGameSession} { }
+
+		/// @brief Sets what the next `generateChoices` generates: the plan fully determines the room.
+		inline void plan(std::uint64_t mSeed, int mRoomNumber, float mDifficulty) noexcept
+		{
+			rng.seed(mSeed);
+			seed = mSeed;
+			roomNumber = mRoomNumber;
+			difficulty = mDifficulty;
+		}
+
+		void generateRndElements(int mL, ElementBitset& mX);
+		int getRndStat(int mL, float, float);
+		InstantEffect generateInstantEffect(InstantEffect::Stat mStat, InstantEffect::Type mType, int mL);
+		void addIEs(int mL, DropIE& dIE);
+
+		DropPool::PtrT<DropIE> generateDropIE(int mL);
+		DropPool::PtrT<WeaponDrop> generateDropWeapon(int mL);
+		DropPool::PtrT<ArmorDrop> generateDropArmor(int mL);
+		DropPtr generateRndDrop(int mL);
+		ItemDrops generateDrops(int mL);
+
+		Weapon generateWeapon(int mL);
+		Armor generateArmor(int mL);
+		Creature generateCreature(int mL);
+
+		ChoicePtr generateChoiceCreature(int mIdx, int mL);
+		ChoicePtr generateChoiceSingleDrop(int mIdx, int mL);
+		ChoicePtr generateChoiceMultipleDrop(int mIdx, int mL);
+
+		/// @brief Generates room `roomNumber` into `choices`, recycling the previous contents.
+		void generateChoices();
+	};
+}
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef GGJ2015_CORE_SPSCQUEUE
+#define GGJ2015_CORE_SPSCQUEUE
+
+#include <atomic>
+#include "../../GGJ2015/Core/Common.hpp"
+
+namespace ggj
+{
+	/// @brief Bounded lock-free queue between exactly one producer thread and one consumer thread.
+	/// `TCapacity` must be a power of two. Pushing to a full queue fails instead of blocking.
+	template<typename T, SizeT TCapacity> class SPSCQueue
+	{
+		static_assert(TCapacity > 0 && (TCapacity & (TCapacity - 1)) == 0, "SPSCQueue capacity must be a power of two");
+
+		private:
+			static constexpr SizeT cacheLine{64};
+
+			T items[TCapacity];
+
+			// Indices grow forever and are masked on access. Each is written by one side only, and
+			// kept on its own cache line so the two sides do not invalidate each other's.
+			alignas(cacheLine) std::atomic<SizeT> head{0};		// Next item to pop, written by the consumer
+			alignas(cacheLine) std::atomic<SizeT> tail{0};		// Next slot to push to, written by the producer
+
+		public:
+			/// @brief Producer only. Returns false if the queue is full.
+			inline bool tryPush(const T& mX) noexcept
+			{
+				auto t(tail.load(std::memory_order_relaxed));
+				if(t - head.load(std::memory_order_acquire) == TCapacity) return false;
+
+				items[t & (TCapacity - 1)] = mX;
+				tail.store(t + 1, std::memory_order_release);
+				return true;
+			}
+
+			/// @brief Consumer only. Returns false if the queue is empty.
+			inline bool tryPop(T& mOut) noexcept
+			{
+				auto h(head.load(std::memory_order_relaxed));
+				if(h == tail.load(std::memory_order_acquire)) return false;
+
+				mOut = items[h & (TCapacity - 1)];
+				head.store(h + 1, std::memory_order_release);
+				return true;
+			}
+
+			inline bool isEmpty() const noexcept
+			{
+				return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+			}
+	};
+}
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef GGJ2015_CORE_SESSIONOBSERVER
+#define GGJ2015_CORE_SESSIONOBSERVER
+
+#include "../../GGJ2015/Core/Common.hpp"
+
+namespace ggj
+{
+	struct Weapon;
+	struct Creature;
+
+	enum class SoundID : int
+	{
+		Powerup = 0,
+		Drop = 1,
+		Grab = 2,
+		EquipArmor = 3,
+		EquipWpn = 4,
+		Lose = 5
+	};
+
+	enum class MusicID : int
+	{
+		Menu = 0,
+		Lvl1 = 1,
+		Lvl2 = 2,
+		Lvl3 = 3,
+		Lvl4 = 4
+	};
+
+	// Presentation and audio hooks of a `GameSession`.
+	// The default implementation does nothing, which is what headless sessions use.
+	struct SessionObserver
+	{
+		inline virtual ~SessionObserver() { }
+
+		inline virtual void onPlaySound(SoundID) { }
+		inline virtual void onPlayAttack(const Weapon&) { }
+		inline virtual void onRefreshMusic(MusicID) { }
+		inline virtual void onPrefetchMusic(MusicID) { }		// Hint: this track will probably play soon
+		inline virtual void onStopMusic() { }
+		inline virtual void onStopSounds() { }
+		inline virtual void onStatBurn(const Creature&, float) { }
+	};
+
+	inline auto& getNullSessionObserver() noexcept { static SessionObserver result; return result; }
+}
+
+#endif
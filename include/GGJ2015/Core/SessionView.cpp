@@ -0,0 +1,79 @@
+#include <cstring>
+#include "../../GGJ2015/Core/Core.hpp"
+
+namespace ggj
+{
+	void DropView::set(const Drop& mX)
+	{
+		type = mX.type;
+		ieCount = 0;
+
+		switch(mX.type)
+		{
+			case Drop::Type::Weapon: weapon = static_cast<const WeaponDrop&>(mX).weapon; break;
+			case Drop::Type::Armor: armor = static_cast<const ArmorDrop&>(mX).armor; break;
+
+			case Drop::Type::IE:
+			{
+				const auto& d(static_cast<const DropIE&>(mX));
+				for(auto i(0u); i < d.ieCount; ++i) ies[i] = d.ies[i];
+				ieCount = d.ieCount;
+				break;
+			}
+		}
+	}
+
+	void SessionView::capture(const GameSession& mGS, const EventLogBuffer& mLog)
+	{
+		state = mGS.state;
+		mode = mGS.mode;
+		roomNumber = mGS.roomNumber;
+		player = mGS.player;
+		timer = mGS.timer;
+		timerEnabled = mGS.timerEnabled;
+		shake = mGS.shake;
+		deathTextTime = mGS.deathTextTime;
+
+		for(auto i(0u); i < Constants::maxChoices; ++i)
+		{
+			const auto* c(mGS.choices[i].get());
+			hasChoice[i] = c != nullptr;
+			if(c == nullptr) continue;
+
+			auto& v(choices[i]);
+			v.id = c;
+			v.type = c->type;
+			v.hasDrop = false;
+
+			if(c->type == Choice::Type::Creature) v.creature = static_cast<const ChoiceCreature*>(c)->creature;
+			else if(c->type == Choice::Type::SingleDrop)
+			{
+				const auto& drop(static_cast<const ChoiceSingleDrop*>(c)->drop);
+				v.hasDrop = drop != nullptr;
+				if(v.hasDrop) v.drop.set(*drop);
+			}
+		}
+
+		dropsID = mGS.currentDrops;
+
+		for(auto i(0u); i < Constants::maxDrops; ++i)
+		{
+			const auto* d(mGS.currentDrops == nullptr ? nullptr : mGS.currentDrops->drops[i].get());
+			hasDrop[i] = d != nullptr;
+			if(d != nullptr) drops[i].set(*d);
+		}
+
+		// The log tail is only copied when a line was completed since the last capture
+		if(mLog.getGeneration() == logGeneration && logSize > 0) return;
+
+		logGeneration = mLog.getGeneration();
+		logSize = 0;
+
+		mLog.forLastLines(logLines, [this](const char* mLine, SizeT mLength)
+		{
+			std::memcpy(log + logSize, mLine, mLength);
+			logSize += mLength;
+			log[logSize++] = '\n';
+		});
+	}
+}
@@ -0,0 +1,67 @@
+#ifndef GGJ2015_CORE_SESSIONVIEW
+#define GGJ2015_CORE_SESSIONVIEW
+
+#include "../../GGJ2015/Core/Common.hpp"
+#include "../../GGJ2015/Core/EventLog.hpp"
+#include "../../GGJ2015/Core/Creature.hpp"
+#include "../../GGJ2015/Core/Drops.hpp"
+#include "../../GGJ2015/Core/Choices.hpp"
+#include "../../GGJ2015/Core/GameSession.hpp"
+
+namespace ggj
+{
+	/// @brief Copy of what is shown of a drop.
+	struct DropView
+	{
+		Drop::Type type{Drop::Type::IE};
+		Weapon weapon;		// Weapon drops only
+		Armor armor;		// Armor drops only
+		InstantEffect ies[DropIE::maxIEs];
+		SizeT ieCount{0};
+
+		void set(const Drop& mX);
+	};
+
+	/// @brief Copy of what is shown of a choice.
+	struct ChoiceView
+	{
+		// Address of the choice in the session, never dereferenced: a different one means a new choice
+		const void* id{nullptr};
+		Choice::Type type{Choice::Type::Advance};
+		Creature creature;		// Creature choices only
+		bool hasDrop{false};	// Single drop choices only
+		DropView drop;
+	};
+
+	/// @brief Copy of everything presentation shows of a `GameSession`: state, player, timer, shake,
+	/// choices, the open drops modal and the tail of the event log. Views only hold values, so they
+	/// can be built on the thread running the session and drawn from another one.
+	struct SessionView
+	{
+		static constexpr SizeT logLines{5};
+
+		GameSession::State state{GameSession::State::Menu};
+		GameSession::Mode mode{GameSession::Mode::Official};
+		int roomNumber{0};
+		Creature player;
+		float timer{0.f};
+		bool timerEnabled{true};
+		float shake{0.f}, deathTextTime{0.f};
+
+		bool hasChoice[Constants::maxChoices]{};
+		ChoiceView choices[Constants::maxChoices];
+
+		const void* dropsID{nullptr};	// Like `ChoiceView::id`, null if the drops modal is closed
+		bool hasDrop[Constants::maxDrops]{};
+		DropView drops[Constants::maxDrops];
+
+		std::uint64_t logGeneration{0};
+		char log[logLines * (EventLogBuffer::lineLength + 1)];
+		SizeT logSize{0};
+
+		/// @brief Overwrites the view with the current state of `mGS` and the tail of `mLog`.
+		void capture(const GameSession& mGS, const EventLogBuffer& mLog = getEventLogBuffer());
+	};
+}
+
+#endif
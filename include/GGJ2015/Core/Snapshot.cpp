@@ -0,0 +1,374 @@
+#include <fstream>
+#include "../../GGJ2015/Core/Core.hpp"
+#include "../../GGJ2015/Core/BinaryIO.hpp"
+
+namespace ggj
+{
+	namespace Impl
+	{
+		// Layout, in order (integers little-endian, reals as IEEE 754 bits):
+		//   header   u32 magic, u16 version, u16 size
+		//   session  u8 state, mode, timerEnabled, currentMusic; i32 roomNumber;
+		//            f32 timer, difficulty, difficultyInc, rndMultiplier, shake, deathTextTime;
+		//            rng and cosmeticRng (4 x u64 each); player; choices; nextChoices;
+		//            i8 choice slot of the open drops modal (-1 if closed);
+		//            next room plan: u64 seed, i32 roomNumber, f32 difficulty
+		//   name     u32 modifiers, i32 level, u8 base, kind, modifierCount
+		//   weapon   name, u8 strongAgainst, weakAgainst, type, i32 atk
+		//   armor    name, u8 elementTypes, i32 def
+		//   creature name, weapon, armor, i32 hps, bonusATK, bonusDEF
+		//   drop     u8 0 (none) or 1 + type, then the weapon, the armor, or u8 count and
+		//            count x (u8 type, u8 stat, f32 value)
+		//   choice   u8 0 (none) or 1 + type, then for a creature: creature and its drops,
+		//            for item drops: `maxDrops` drops, for a single drop: a drop
+		constexpr SizeT snapshotHeaderSize{8};
+
+		inline void put(BinaryWriter& mW, const Name& mX)
+		{
+			mW.putInt(mX.modifiers);
+			mW.putInt(mX.level);
+			mW.putInt(mX.base);
+			mW.putEnum(mX.kind);
+			mW.putInt(mX.modifierCount);
+		}
+
+		inline void get(BinaryReader& mR, Name& mX)
+		{
+			mX.modifiers = mR.getInt<std::uint32_t>();
+			mX.level = mR.getInt<std::int32_t>();
+			mX.base = mR.getInt<std::uint8_t>();
+			mX.kind = mR.getEnum(Name::Kind::Generated);
+			mX.modifierCount = mR.getInt<std::uint8_t>();
+
+			if(mX.modifierCount > Name::maxModifiers) mR.fail();
+		}
+
+		inline void put(BinaryWriter& mW, const Weapon& mX)
+		{
+			put(mW, mX.name);
+			mW.putInt(mX.strongAgainst.getBits());
+			mW.putInt(mX.weakAgainst.getBits());
+			mW.putEnum(mX.type);
+			mW.putInt(static_cast<std::int32_t>(mX.atk));
+		}
+
+		inline void get(BinaryReader& mR, Weapon& mX)
+		{
+			get(mR, mX.name);
+			mX.strongAgainst = ElementBitset(mR.getInt<std::uint8_t>());
+			mX.weakAgainst = ElementBitset(mR.getInt<std::uint8_t>());
+			mX.type = mR.getEnum(Weapon::Type::Spear);
+			mX.atk = mR.getInt<std::int32_t>();
+		}
+
+		inline void put(BinaryWriter& mW, const Armor& mX)
+		{
+			put(mW, mX.name);
+			mW.putInt(mX.elementTypes.getBits());
+			mW.putInt(static_cast<std::int32_t>(mX.def));
+		}
+
+		inline void get(BinaryReader& mR, Armor& mX)
+		{
+			get(mR, mX.name);
+			mX.elementTypes = ElementBitset(mR.getInt<std::uint8_t>());
+			mX.def = mR.getInt<std::int32_t>();
+		}
+
+		inline void put(BinaryWriter& mW, const Creature& mX)
+		{
+			put(mW, mX.name);
+			put(mW, mX.weapon);
+			put(mW, mX.armor);
+			mW.putInt(static_cast<std::int32_t>(mX.hps));
+			mW.putInt(static_cast<std::int32_t>(mX.bonusATK));
+			mW.putInt(static_cast<std::int32_t>(mX.bonusDEF));
+		}
+
+		inline void get(BinaryReader& mR, Creature& mX)
+		{
+			get(mR, mX.name);
+			get(mR, mX.weapon);
+			get(mR, mX.armor);
+			mX.hps = mR.getInt<std::int32_t>();
+			mX.bonusATK = mR.getInt<std::int32_t>();
+			mX.bonusDEF = mR.getInt<std::int32_t>();
+		}
+
+		inline void put(BinaryWriter& mW, const Rng& mX)
+		{
+			for(auto x : mX.getState()) mW.putInt(x);
+		}
+
+		inline void get(BinaryReader& mR, Rng& mX)
+		{
+			Rng::State state;
+			for(auto& x : state) x = mR.getInt<std::uint64_t>();
+			mX.setState(state);
+		}
+
+		inline void put(BinaryWriter& mW, const DropPtr& mX)
+		{
+			if(mX == nullptr) { mW.putInt(std::uint8_t{0}); return; }
+
+			mW.putInt(static_cast<std::uint8_t>(1 + static_cast<int>(mX->type)));
+
+			switch(mX->type)
+			{
+				case Drop::Type::Weapon: put(mW, static_cast<const WeaponDrop&>(*mX).weapon); break;
+				case Drop::Type::Armor: put(mW, static_cast<const ArmorDrop&>(*mX).armor); break;
+				case Drop::Type::IE:
+				{
+					const auto& d(static_cast<const DropIE&>(*mX));
+					mW.putInt(static_cast<std::uint8_t>(d.ieCount));
+
+					for(auto i(0u); i < d.ieCount; ++i)
+					{
+						mW.putEnum(d.ies[i].type);
+						mW.putEnum(d.ies[i].stat);
+						mW.putFloat(d.ies[i].value);
+					}
+
+					break;
+				}
+			}
+		}
+
+		inline void get(BinaryReader& mR, GameSession& mGS, DropPtr& mX)
+		{
+			auto tag(mR.getInt<std::uint8_t>());
+			if(tag == 0) return;
+
+			auto& pool(mGS.getRoomGen().dropPool);
+
+			switch(static_cast<Drop::Type>(tag - 1))
+			{
+				case Drop::Type::Weapon:
+				{
+					auto d(pool.create<WeaponDrop>(mGS));
+					get(mR, d->weapon);
+					mX = std::move(d);
+					return;
+				}
+				case Drop::Type::Armor:
+				{
+					auto d(pool.create<ArmorDrop>(mGS));
+					get(mR, d->armor);
+					mX = std::move(d);
+					return;
+				}
+				case Drop::Type::IE:
+				{
+					auto d(pool.create<DropIE>(mGS));
+					auto count(mR.getInt<std::uint8_t>());
+					if(count > DropIE::maxIEs) { mR.fail(); return; }
+
+					for(auto i(0u); i < count; ++i)
+					{
+						auto type(mR.getEnum(InstantEffect::Type::Div));
+						auto stat(mR.getEnum(InstantEffect::Stat::SDEF));
+						d->addIE({type, stat, mR.getFloat()});
+					}
+
+					mX = std::move(d);
+					return;
+				}
+			}
+
+			mR.fail();
+		}
+
+		inline void put(BinaryWriter& mW, const ItemDrops& mX)
+		{
+			for(const auto& d : mX.drops) put(mW, d);
+		}
+
+		inline void get(BinaryReader& mR, GameSession& mGS, ItemDrops& mX)
+		{
+			for(auto& d : mX.drops) get(mR, mGS, d);
+		}
+
+		inline void put(BinaryWriter& mW, const ChoicePtr& mX)
+		{
+			if(mX == nullptr) { mW.putInt(std::uint8_t{0}); return; }
+
+			mW.putInt(static_cast<std::uint8_t>(1 + static_cast<int>(mX->type)));
+
+			switch(mX->type)
+			{
+				case Choice::Type::Advance: break;
+				case Choice::Type::Creature:
+				{
+					const auto& c(static_cast<const ChoiceCreature&>(*mX));
+					put(mW, c.creature);
+					put(mW, c.drops);
+					break;
+				}
+				case Choice::Type::ItemDrop: put(mW, static_cast<const ChoiceItemDrop&>(*mX).itemDrops); break;
+				case Choice::Type::SingleDrop: put(mW, static_cast<const ChoiceSingleDrop&>(*mX).drop); break;
+			}
+		}
+
+		inline void get(BinaryReader& mR, GameSession& mGS, SizeT mIdx, ChoicePtr& mX)
+		{
+			auto tag(mR.getInt<std::uint8_t>());
+			if(tag == 0) return;
+
+			auto& pool(mGS.getRoomGen().choicePool);
+
+			switch(static_cast<Choice::Type>(tag - 1))
+			{
+				case Choice::Type::Advance: mX = pool.create<ChoiceAdvance>(mGS, mIdx); return;
+				case Choice::Type::Creature:
+				{
+					auto c(pool.create<ChoiceCreature>(mGS, mIdx));
+					get(mR, c->creature);
+					get(mR, mGS, c->drops);
+					mX = std::move(c);
+					return;
+				}
+				case Choice::Type::ItemDrop:
+				{
+					auto c(pool.create<ChoiceItemDrop>(mGS, mIdx));
+					get(mR, mGS, c->itemDrops);
+					mX = std::move(c);
+					return;
+				}
+				case Choice::Type::SingleDrop:
+				{
+					auto c(pool.create<ChoiceSingleDrop>(mGS, mIdx));
+					get(mR, mGS, c->drop);
+					mX = std::move(c);
+					return;
+				}
+			}
+
+			mR.fail();
+		}
+
+		inline std::int8_t getDropsSlot(const GameSession& mGS) noexcept
+		{
+			for(auto i(0u); i < Constants::maxChoices; ++i)
+			{
+				const auto& c(mGS.choices[i]);
+				if(c != nullptr && c->type == Choice::Type::ItemDrop && &static_cast<const ChoiceItemDrop&>(*c).itemDrops == mGS.currentDrops)
+					return static_cast<std::int8_t>(i);
+			}
+
+			SSVU_ASSERT(mGS.currentDrops == nullptr);
+			return -1;
+		}
+	}
+
+	void SessionSnapshot::capture(const GameSession& mGS)
+	{
+		using namespace Impl;
+
+		BinaryWriter w{data.data() + snapshotHeaderSize, data.data() + data.size()};
+
+		w.putEnum(mGS.state);
+		w.putEnum(mGS.mode);
+		w.putInt(static_cast<std::uint8_t>(mGS.timerEnabled));
+		w.putEnum(mGS.currentMusic);
+		w.putInt(static_cast<std::int32_t>(mGS.roomNumber));
+
+		for(auto x : {mGS.timer, mGS.difficulty, mGS.difficultyInc, mGS.rndMultiplier, mGS.shake, mGS.deathTextTime}) w.putFloat(x);
+
+		put(w, mGS.rng);
+		put(w, mGS.cosmeticRng);
+		put(w, mGS.player);
+		for(const auto& c : mGS.choices) put(w, c);
+		for(const auto& c : mGS.nextChoices) put(w, c);
+		w.putInt(getDropsSlot(mGS));
+
+		const auto& next(mGS.roomGens[1 - mGS.currentRoomGen]);
+		w.putInt(next.seed);
+		w.putInt(static_cast<std::int32_t>(next.roomNumber));
+		w.putFloat(next.difficulty);
+
+		size = w.getPtr() - data.data();
+
+		BinaryWriter header{data.data(), data.data() + snapshotHeaderSize};
+		header.putInt(Snapshot::magic);
+		header.putInt(Snapshot::version);
+		header.putInt(static_cast<std::uint16_t>(size));
+	}
+
+	bool SessionSnapshot::restore(GameSession& mGS) const
+	{
+		using namespace Impl;
+
+		mGS.discardNextRoom();
+		mGS.endDrops();
+		for(auto& c : mGS.choices) c.reset();
+		for(auto& c : mGS.nextChoices) c.reset();
+
+		BinaryReader r{data.data(), data.data() + size};
+
+		if(r.getInt<std::uint32_t>() != Snapshot::magic || r.getInt<std::uint16_t>() != Snapshot::version || r.getInt<std::uint16_t>() != size)
+			r.fail();
+
+		mGS.state = r.getEnum(GameSession::State::Menu);
+		mGS.mode = r.getEnum(GameSession::Mode::Hardcore);
+		mGS.timerEnabled = r.getInt<std::uint8_t>() != 0;
+		mGS.currentMusic = r.getEnum(MusicID::Lvl4);
+		mGS.roomNumber = r.getInt<std::int32_t>();
+
+		for(auto* x : {&mGS.timer, &mGS.difficulty, &mGS.difficultyInc, &mGS.rndMultiplier, &mGS.shake, &mGS.deathTextTime}) *x = r.getFloat();
+
+		get(r, mGS.rng);
+		get(r, mGS.cosmeticRng);
+		get(r, mGS.player);
+		for(auto i(0u); i < Constants::maxChoices; ++i) get(r, mGS, i, mGS.choices[i]);
+		for(auto i(0u); i < Constants::maxChoices; ++i) get(r, mGS, i, mGS.nextChoices[i]);
+
+		auto dropsSlot(r.getInt<std::int8_t>());
+		if(dropsSlot >= 0)
+		{
+			auto* c(dropsSlot < static_cast<int>(Constants::maxChoices) ? mGS.choices[dropsSlot].get() : nullptr);
+			if(c == nullptr || c->type != Choice::Type::ItemDrop) r.fail();
+			else mGS.startDrops(&static_cast<ChoiceItemDrop&>(*c).itemDrops);
+		}
+
+		auto seed(r.getInt<std::uint64_t>());
+		auto nextRoom(r.getInt<std::int32_t>());
+		mGS.getNextRoomGen().plan(seed, nextRoom, r.getFloat());
+
+		if(!r.isOk() || !r.isAtEnd())
+		{
+			mGS.endDrops();
+			for(auto& c : mGS.choices) c.reset();
+			for(auto& c : mGS.nextChoices) c.reset();
+			mGS.gotoMenu();
+			return false;
+		}
+
+		if(mGS.state == GameSession::State::Playing && mGS.pregenerate) mGS.prepareNextRoom();
+		return true;
+	}
+
+	bool SessionSnapshot::readFromBuffer(const std::uint8_t* mData, SizeT mSize)
+	{
+		if(mSize < Impl::snapshotHeaderSize || mSize > data.size()) return false;
+
+		std::copy(mData, mData + mSize, data.begin());
+		size = mSize;
+		return true;
+	}
+
+	bool SessionSnapshot::writeToFile(const std::string& mPath) const
+	{
+		std::ofstream o{mPath, std::ios::binary};
+		o.write(reinterpret_cast<const char*>(data.data()), size);
+		return static_cast<bool>(o);
+	}
+
+	bool SessionSnapshot::readFromFile(const std::string& mPath)
+	{
+		std::ifstream i{mPath, std::ios::binary};
+		i.read(reinterpret_cast<char*>(data.data()), data.size());
+
+		size = i.gcount();
+		return i.eof() && size >= Impl::snapshotHeaderSize;
+	}
+}
@@ -0,0 +1,51 @@
+#ifndef GGJ2015_CORE_SNAPSHOT
+#define GGJ2015_CORE_SNAPSHOT
+
+#include "../../GGJ2015/Core/Common.hpp"
+
+namespace ggj
+{
+	struct GameSession;
+
+	namespace Snapshot
+	{
+		constexpr std::uint32_t magic{0x534a4747};		// "GGJS", little-endian
+		constexpr std::uint16_t version{1};
+
+		// Worst case: every choice and pending choice is a creature carrying a full set of drops.
+		// Typical snapshots are a few hundred bytes.
+		constexpr SizeT capacity{2048};
+	}
+
+	/// @brief Binary image of a `GameSession`: player, choices and their drops, open drops modal,
+	/// timer, difficulty, mode, random streams and the plan of the next room. The layout is fixed
+	/// (fields in a set order, fixed-width little-endian values) and starts with a versioned header.
+	/// Capturing and restoring use no heap memory, so a session can be checkpointed every room.
+	class SessionSnapshot
+	{
+		private:
+			std::array<std::uint8_t, Snapshot::capacity> data;
+			SizeT size{0};
+
+		public:
+			inline const std::uint8_t* getData() const noexcept { return data.data(); }
+			inline SizeT getSize() const noexcept { return size; }
+
+			/// @brief Replaces the contents with a snapshot of `mGS`. A generation running on a worker
+			/// is neither waited for nor captured: only its plan is, which fully determines it.
+			void capture(const GameSession& mGS);
+
+			/// @brief Restores `mGS` to the captured state. Returns false if the snapshot is invalid
+			/// or from another version, leaving `mGS` in the menu.
+			bool restore(GameSession& mGS) const;
+
+			/// @brief Replaces the contents with `mSize` bytes written by another snapshot. Returns false
+			/// if they cannot be one, without checking the version: `restore` does.
+			bool readFromBuffer(const std::uint8_t* mData, SizeT mSize);
+
+			bool writeToFile(const std::string& mPath) const;
+			bool readFromFile(const std::string& mPath);
+	};
+}
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef GGJ2015_CORE_TRIPLEBUFFER
+#define GGJ2015_CORE_TRIPLEBUFFER
+
+#include <atomic>
+#include "../../GGJ2015/Core/Common.hpp"
+
+namespace ggj
+{
+	/// @brief Lock-free hand-over of the latest value from one writer thread to one reader thread.
+	/// The writer fills its back buffer and publishes it; the reader takes the latest published one.
+	/// Neither side ever waits: a third slot is exchanged between them, so the writer never writes
+	/// into the buffer being read. Values published while the reader is busy are skipped.
+	template<typename T> class TripleBuffer
+	{
+		private:
+			static constexpr unsigned int indexMask{3}, freshBit{4};
+
+			T slots[3];
+			std::atomic<unsigned int> middle{1};	// Slot exchanged between the sides, with `freshBit` if unread
+			unsigned int back{0};					// Writer only
+			unsigned int front{2};					// Reader only
+
+		public:
+			/// @brief Writer only. The buffer holds an older value: it must be fully rewritten.
+			inline T& getBack() noexcept { return slots[back]; }
+
+			/// @brief Writer only. Makes the back buffer the latest value.
+			inline void publish() noexcept
+			{
+				back = middle.exchange(back | freshBit, std::memory_order_acq_rel) & indexMask;
+			}
+
+			/// @brief Reader only. Takes the latest value if a new one was published since the last call.
+			/// Returns true if it did.
+			inline bool update() noexcept
+			{
+				if((middle.load(std::memory_order_relaxed) & freshBit) == 0) return false;
+
+				front = middle.exchange(front, std::memory_order_acq_rel) & indexMask;
+				return true;
+			}
+
+			/// @brief Reader only. Valid until the next `update`.
+			inline const T& getFront() const noexcept { return slots[front]; }
+	};
+}
+
+#endif
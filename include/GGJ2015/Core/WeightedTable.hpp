@@ -0,0 +1,94 @@
+#ifndef GGJ2015_CORE_WEIGHTEDTABLE
+#define GGJ2015_CORE_WEIGHTEDTABLE
+
+#include "../../GGJ2015/Core/Common.hpp"
+#include "../../GGJ2015/Core/Rng.hpp"
+
+namespace ggj
+{
+	template<typename T> struct WeightedEntry
+	{
+		float weight;
+		T value;
+	};
+
+	// Walker/Vose alias table: samples a weighted discrete distribution in O(1) with two draws.
+	// Build it with `mkWeightedTable`, which is `constexpr` so that static tables are computed at compile time.
+	template<typename T, SizeT TN> struct WeightedTable
+	{
+		T values[TN]{};
+		float weights[TN]{};
+		float prob[TN]{};
+		SizeT alias[TN]{};
+
+		inline static constexpr SizeT size() noexcept { return TN; }
+
+		inline SizeT getIdx(Rng& mRng) const noexcept
+		{
+			auto i(mRng.getBounded(TN));
+			return mRng.getUnit<float>() < prob[i] ? i : alias[i];
+		}
+
+		inline const T& get(Rng& mRng) const noexcept { return values[getIdx(mRng)]; }
+
+		/// @brief Probability of entry `mIdx` according to its weight.
+		inline constexpr double getExpectedProbability(SizeT mIdx) const noexcept
+		{
+			double weightSum{0};
+			for(auto w : weights) weightSum += w;
+			return weights[mIdx] / weightSum;
+		}
+
+		/// @brief Probability of sampling entry `mIdx`, as encoded by the alias table.
+		inline constexpr double getProbability(SizeT mIdx) const noexcept
+		{
+			double result{prob[mIdx]};
+			for(auto i(0u); i < TN; ++i) if(alias[i] == mIdx && i != mIdx) result += 1.0 - prob[i];
+			return result / TN;
+		}
+	};
+
+	template<typename T, SizeT TN> inline constexpr auto mkWeightedTable(const WeightedEntry<T>(&mEntries)[TN])
+	{
+		WeightedTable<T, TN> result;
+
+		double weightSum{0};
+		for(auto i(0u); i < TN; ++i) weightSum += mEntries[i].weight;
+
+		double scaled[TN]{};
+		SizeT small[TN]{}, large[TN]{};
+		SizeT smallCount{0}, largeCount{0};
+
+		for(auto i(0u); i < TN; ++i)
+		{
+			result.values[i] = mEntries[i].value;
+			result.weights[i] = mEntries[i].weight;
+			scaled[i] = mEntries[i].weight * TN / weightSum;
+
+			if(scaled[i] < 1.0) small[smallCount++] = i;
+			else large[largeCount++] = i;
+		}
+
+		while(smallCount > 0 && largeCount > 0)
+		{
+			auto s(small[--smallCount]);
+			auto l(large[--largeCount]);
+
+			result.prob[s] = static_cast<float>(scaled[s]);
+			result.alias[s] = l;
+
+			scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+
+			if(scaled[l] < 1.0) small[smallCount++] = l;
+			else large[largeCount++] = l;
+		}
+
+		// Leftovers are 1.0 up to rounding errors
+		while(largeCount > 0) { auto l(large[--largeCount]); result.prob[l] = 1.f; result.alias[l] = l; }
+		while(smallCount > 0) { auto s(small[--smallCount]); result.prob[s] = 1.f; result.alias[s] = s; }
+
+		return result;
+	}
+}
+
+#endif
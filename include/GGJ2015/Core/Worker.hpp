@@ -0,0 +1,99 @@
+#ifndef GGJ2015_CORE_WORKER
+#define GGJ2015_CORE_WORKER
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "../../GGJ2015/Core/Common.hpp"
+
+namespace ggj
+{
+	/// @brief A thread running one task at a time for a single owner. The task is handed over
+	/// through a preallocated slot (a function pointer and its argument), so starting one neither
+	/// allocates nor creates a thread. The thread is created by the first `start` and joined on
+	/// destruction, after finishing the pending task.
+	class Worker
+	{
+		public:
+			using Task = void(*)(void*);
+
+		private:
+			std::mutex mutex;
+			std::condition_variable cv;
+			std::thread thread;
+
+			Task task{nullptr};
+			void* taskArg{nullptr};
+			bool busy{false}, quitting{false};		// Shared, guarded by `mutex`
+			bool pending{false};					// Owner only: started and not yet waited for
+
+			inline void run()
+			{
+				std::unique_lock<std::mutex> lock{mutex};
+
+				while(true)
+				{
+					cv.wait(lock, [this]{ return busy || quitting; });
+					if(!busy) return;
+
+					lock.unlock();
+					task(taskArg);
+					lock.lock();
+
+					busy = false;
+					cv.notify_all();
+				}
+			}
+
+		public:
+			inline Worker() = default;
+
+			Worker(const Worker&) = delete;
+			Worker& operator=(const Worker&) = delete;
+
+			inline ~Worker()
+			{
+				if(!thread.joinable()) return;
+
+				{
+					std::lock_guard<std::mutex> lock{mutex};
+					quitting = true;
+				}
+
+				cv.notify_all();
+				thread.join();
+			}
+
+			/// @brief Returns true if a task was started and not waited for yet.
+			inline bool isPending() const noexcept { return pending; }
+
+			/// @brief Runs `mTask(mArg)` on the worker thread. The previous task must have been waited for.
+			inline void start(Task mTask, void* mArg)
+			{
+				SSVU_ASSERT(!pending);
+				if(!thread.joinable()) thread = std::thread{[this]{ run(); }};
+
+				{
+					std::lock_guard<std::mutex> lock{mutex};
+					task = mTask;
+					taskArg = mArg;
+					busy = true;
+				}
+
+				pending = true;
+				cv.notify_all();
+			}
+
+			/// @brief Waits for the pending task, if any, to finish.
+			inline void wait()
+			{
+				if(!pending) return;
+
+				std::unique_lock<std::mutex> lock{mutex};
+				cv.wait(lock, [this]{ return !busy; });
+				pending = false;
+			}
+	};
+}
+
+#endif
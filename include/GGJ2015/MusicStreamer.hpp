@@ -0,0 +1,115 @@
+#ifndef GGJ2015_MUSICSTREAMER
+#define GGJ2015_MUSICSTREAMER
+
+#include <future>
+#include <fstream>
+#include "../GGJ2015/Common.hpp"
+
+namespace ggj
+{
+	/// @brief Where a track is streamed from: a file, or encoded data in memory that outlives
+	/// the streamer (such as a mapped archive).
+	struct MusicSource
+	{
+		std::string path;
+		const char* data{nullptr};
+		SizeT size{0};
+	};
+
+	/// @brief Plays looping tracks through `sf::Music`, which decodes small chunks on its own thread:
+	/// no track is ever fully decoded in memory. `prefetch` opens the next track in the background and
+	/// pages in its first chunk, so that `play` can switch to it without touching the disk.
+	class MusicStreamer
+	{
+		private:
+			static constexpr SizeT prefetchBytes{256 * 1024};
+
+			struct Track
+			{
+				sf::Music music;
+				std::string id;
+				std::future<bool> opening;
+				bool open{false};
+			};
+
+			Track tracks[2];
+			Track* current{&tracks[0]};
+			Track* next{&tracks[1]};
+			float volume{100.f};
+
+			inline static bool openTrack(sf::Music& mMusic, const MusicSource& mSrc)
+			{
+				if(mSrc.data != nullptr)
+				{
+					volatile char sink{0};
+					for(auto i(0u); i < mSrc.size && i < prefetchBytes; i += 4096) sink = sink + mSrc.data[i];
+
+					return mMusic.openFromMemory(mSrc.data, mSrc.size);
+				}
+
+				std::ifstream f{mSrc.path, std::ios::binary};
+				char buffer[4096];
+				for(auto i(0u); i < prefetchBytes && f.read(buffer, sizeof(buffer)); i += sizeof(buffer)) { }
+
+				return mMusic.openFromFile(mSrc.path);
+			}
+
+			inline void wait(Track& mX)
+			{
+				if(mX.opening.valid()) mX.open = mX.opening.get();
+			}
+
+			inline void startOpening(Track& mX, const std::string& mID, const MusicSource& mSrc)
+			{
+				wait(mX);
+
+				mX.music.stop();
+				mX.id = mID;
+				mX.open = false;
+				mX.opening = std::async(std::launch::async, [&mX, mSrc]{ return openTrack(mX.music, mSrc); });
+			}
+
+		public:
+			inline MusicStreamer() = default;
+			inline ~MusicStreamer() { wait(tracks[0]); wait(tracks[1]); }
+
+			inline MusicStreamer(const MusicStreamer&) = delete;
+			inline MusicStreamer& operator=(const MusicStreamer&) = delete;
+
+			/// @brief Opens `mID` in the background, unless it is already playing or prefetched.
+			inline void prefetch(const std::string& mID, const MusicSource& mSrc)
+			{
+				if(current->id == mID || next->id == mID) return;
+				startOpening(*next, mID, mSrc);
+			}
+
+			/// @brief Loops `mID`, switching from the current track. Blocks only if `mID` was not prefetched in time.
+			inline void play(const std::string& mID, const MusicSource& mSrc)
+			{
+				if(current->id != mID)
+				{
+					if(next->id != mID) startOpening(*next, mID, mSrc);
+					wait(*next);
+
+					current->music.stop();
+					std::swap(current, next);
+				}
+
+				if(!current->open || current->music.getStatus() == sf::Music::Playing) return;
+
+				current->music.setLoop(true);
+				current->music.setVolume(volume);
+				current->music.play();
+			}
+
+			inline void stop() { current->music.stop(); }
+
+			inline void setVolume(float mX)
+			{
+				volume = mX;
+				current->music.setVolume(mX);
+			}
+	};
+}
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef GGJ2015_SIM_POLICY
+#define GGJ2015_SIM_POLICY
+
+#include "../../GGJ2015/Core/Core.hpp"
+
+namespace ggj
+{
+	namespace Sim
+	{
+		// Scripted greedy player: loots everything that looks like an upgrade, fights what it can beat, then advances.
+		struct GreedyPolicy
+		{
+			static constexpr int wait{-1};
+
+			inline static int getIEValue(const GameSession& mGS, const DropIE& mD)
+			{
+				auto p(mGS.player);
+				int value{0};
+
+				for(auto i(0u); i < mD.ieCount; ++i)
+				{
+					const auto& ie(mD.ies[i]);
+					StatType* statPtr{nullptr};
+
+					switch(ie.stat)
+					{
+						case InstantEffect::Stat::SHPS: statPtr = &p.hps; break;
+						case InstantEffect::Stat::SATK: statPtr = &p.bonusATK; break;
+						case InstantEffect::Stat::SDEF: statPtr = &p.bonusDEF; break;
+					}
+
+					auto delta(static_cast<int>(ie.value));
+					if(ie.type == InstantEffect::Type::Sub) delta = -delta;
+
+					*statPtr += delta;
+					value += ie.stat == InstantEffect::Stat::SHPS ? delta / 10 : delta * 3;
+				}
+
+				// Stat burn, see `Creature::checkBurns`
+				auto burn(ssvu::getClampedMin(-p.bonusATK, 0) + ssvu::getClampedMin(-p.bonusDEF, 0));
+				auto burnHPS(burn * (4 * mGS.roomNumber * mGS.difficulty));
+
+				if(p.hps - burnHPS <= 0) return -1;
+				return value - static_cast<int>(burnHPS / 10);
+			}
+
+			inline static bool isWorthPicking(const GameSession& mGS, const Drop& mD)
+			{
+				switch(mD.type)
+				{
+					case Drop::Type::Weapon: return static_cast<const WeaponDrop&>(mD).weapon.atk > mGS.player.weapon.atk;
+					case Drop::Type::Armor: return static_cast<const ArmorDrop&>(mD).armor.def > mGS.player.armor.def;
+					case Drop::Type::IE: return getIEValue(mGS, static_cast<const DropIE&>(mD)) > 0;
+				}
+
+				return false;
+			}
+
+			/// @brief Returns the remaining player HPS after fighting `mC`, or a non-positive value on defeat.
+			inline static HPS getFightOutcome(const GameSession& mGS, const Creature& mC)
+			{
+				auto p(mGS.player);
+				auto c(mC);
+
+				if(!p.canDamage(c)) return 0;
+
+				p.fight(c);
+				return p.hps;
+			}
+
+			/// @brief Returns the key (0..3) to press next, or `wait` if nothing is worth pressing.
+			inline int pick(GameSession& mGS)
+			{
+				if(mGS.currentDrops != nullptr)
+				{
+					for(auto i(0u); i < Constants::maxDrops; ++i)
+						if(mGS.currentDrops->has(i) && isWorthPicking(mGS, *mGS.currentDrops->drops[i]))
+							return i + 1;
+
+					return 0;
+				}
+
+				int bestFight{wait}, desperateFight{wait}, loot{wait}, advance{wait};
+				HPS bestFightHPS{0}, desperateFightHPS{std::numeric_limits<HPS>::min()};
+
+				for(auto i(0u); i < Constants::maxChoices; ++i)
+				{
+					const auto& c(mGS.choices[i]);
+					if(c == nullptr) continue;
+
+					switch(c->type)
+					{
+						case Choice::Type::Advance: advance = i; break;
+						case Choice::Type::ItemDrop: loot = i; break;
+
+						case Choice::Type::SingleDrop:
+						{
+							const auto& d(static_cast<const ChoiceSingleDrop&>(*c).drop);
+							if(d != nullptr && isWorthPicking(mGS, *d)) loot = i;
+							break;
+						}
+
+						case Choice::Type::Creature:
+						{
+							const auto& cr(static_cast<const ChoiceCreature&>(*c).creature);
+							if(!mGS.player.canDamage(cr)) break;
+
+							auto hps(getFightOutcome(mGS, cr));
+
+							if(hps > bestFightHPS) { bestFightHPS = hps; bestFight = i; }
+							if(hps > desperateFightHPS) { desperateFightHPS = hps; desperateFight = i; }
+							break;
+						}
+					}
+				}
+
+				if(loot != wait) return loot;
+				if(bestFight != wait) return bestFight;
+				if(advance != wait) return advance;
+				return desperateFight;
+			}
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,259 @@
+#ifndef GGJ2015_SIM_RUNNER
+#define GGJ2015_SIM_RUNNER
+
+#include <thread>
+#include <mutex>
+#include <deque>
+#include <chrono>
+#include "../../GGJ2015/Core/Core.hpp"
+#include "../../GGJ2015/Sim/Policy.hpp"
+#include "../../GGJ2015/Sim/Search.hpp"
+
+namespace ggj
+{
+	namespace Sim
+	{
+		enum class Cause : int
+		{
+			Timer = 0,
+			HPS = 1,
+			Burn = 2,
+			Stuck = 3,
+			RoomCap = 4
+		};
+
+		static constexpr SizeT causeCount{5};
+
+		inline const auto& getCauseStr(Cause mX)
+		{
+			static auto array(ssvu::makeArray
+			(
+				"timer",
+				"HPS",
+				"stat burn",
+				"stuck",
+				"room cap"
+			));
+
+			return array[static_cast<int>(mX)];
+		}
+
+		enum class Bot : int
+		{
+			Greedy = 0,
+			Search = 1
+		};
+
+		struct Config
+		{
+			GameSession::Mode mode{GameSession::Mode::Official};
+			std::uint64_t seed{0};
+			SizeT runs{100000};
+			SizeT threads{std::thread::hardware_concurrency()};
+			SizeT batchSize{256};
+			float thinkSeconds{0.5f};
+			int maxRooms{500};
+			Bot bot{Bot::Greedy};
+			SearchConfig search;		// `search.thinkSeconds` is set from `thinkSeconds`
+		};
+
+		struct RunResult
+		{
+			int room;
+			Cause cause;
+			int presses;
+		};
+
+		// Per-worker accumulator, merged once all workers are done.
+		struct Stats
+		{
+			std::vector<std::uint64_t> roomHistogram;
+			std::uint64_t causes[causeCount]{};
+			std::uint64_t runs{0}, rooms{0}, presses{0};
+
+			inline void add(const RunResult& mX)
+			{
+				auto room(static_cast<SizeT>(mX.room));
+				if(roomHistogram.size() <= room) roomHistogram.resize(room + 1, 0);
+
+				++roomHistogram[room];
+				++causes[static_cast<int>(mX.cause)];
+				++runs;
+				rooms += room;
+				presses += mX.presses;
+			}
+
+			inline void merge(const Stats& mX)
+			{
+				if(roomHistogram.size() < mX.roomHistogram.size()) roomHistogram.resize(mX.roomHistogram.size(), 0);
+				for(auto i(0u); i < mX.roomHistogram.size(); ++i) roomHistogram[i] += mX.roomHistogram[i];
+				for(auto i(0u); i < causeCount; ++i) causes[i] += mX.causes[i];
+				runs += mX.runs;
+				rooms += mX.rooms;
+				presses += mX.presses;
+			}
+		};
+
+		struct BurnObserver : public SessionObserver
+		{
+			bool burned{false};
+			inline void onStatBurn(const Creature&, float) override { burned = true; }
+		};
+
+		/// @brief Plays a full run with `mPolicy`, spending `thinkSeconds` of room timer per key press.
+		template<typename TPolicy> inline RunResult playRun(const Config& mCfg, TPolicy& mPolicy, std::uint64_t mSeed)
+		{
+			BurnObserver observer;
+			GameSession gs{observer};
+
+			gs.seed(mSeed);
+			gs.mode = mCfg.mode;
+			gs.restart();
+
+			auto thinkFT(ssvu::getSecondsToFT(mCfg.thinkSeconds));
+			int presses{0};
+
+			while(true)
+			{
+				if(gs.roomNumber >= mCfg.maxRooms) return {gs.roomNumber, Cause::RoomCap, presses};
+
+				auto key(mPolicy.pick(gs));
+
+				if(key == TPolicy::wait)
+					return {gs.roomNumber, gs.timerEnabled ? Cause::Timer : Cause::Stuck, presses};
+
+				if(gs.timerEnabled)
+				{
+					gs.timer -= thinkFT;
+					if(gs.timer <= 0) { gs.die(); return {gs.roomNumber, Cause::Timer, presses}; }
+				}
+
+				observer.burned = false;
+				gs.executeChoice(key);
+				++presses;
+
+				if(gs.player.isDead())
+				{
+					gs.die();
+					return {gs.roomNumber, observer.burned ? Cause::Burn : Cause::HPS, presses};
+				}
+			}
+		}
+
+		// Work-stealing scheduler: every worker owns a deque of batches, pops from its back and
+		// steals from the front of the others' deques when it runs dry.
+		class Runner
+		{
+			private:
+				struct Batch { SizeT begin, end; };
+
+				struct Worker
+				{
+					std::mutex mtx;
+					std::deque<Batch> batches;
+					Stats stats;
+					std::uint64_t steals{0};
+				};
+
+				Config cfg;
+				std::vector<ssvu::UPtr<Worker>> workers;
+
+				inline bool popOwn(Worker& mW, Batch& mOut)
+				{
+					std::lock_guard<std::mutex> lock{mW.mtx};
+					if(mW.batches.empty()) return false;
+
+					mOut = mW.batches.back();
+					mW.batches.pop_back();
+					return true;
+				}
+
+				inline bool steal(SizeT mThief, Batch& mOut)
+				{
+					for(auto i(1u); i < workers.size(); ++i)
+					{
+						auto& victim(*workers[(mThief + i) % workers.size()]);
+						std::lock_guard<std::mutex> lock{victim.mtx};
+						if(victim.batches.empty()) continue;
+
+						mOut = victim.batches.front();
+						victim.batches.pop_front();
+						return true;
+					}
+
+					return false;
+				}
+
+				inline void work(SizeT mIdx)
+				{
+					auto& w(*workers[mIdx]);
+					Batch b;
+
+					GreedyPolicy greedy;
+					ssvu::UPtr<SearchPolicy> search;
+					if(cfg.bot == Bot::Search) search = ssvu::makeUPtr<SearchPolicy>(cfg.search);
+
+					while(true)
+					{
+						if(!popOwn(w, b))
+						{
+							if(!steal(mIdx, b)) return;
+							++w.steals;
+						}
+
+						for(auto i(b.begin); i < b.end; ++i)
+						{
+							auto seed(cfg.seed + i);
+							if(search == nullptr) { w.stats.add(playRun(cfg, greedy, seed)); continue; }
+
+							// Fresh transpositions for every run: results do not depend on which worker plays it
+							search->reset(seed);
+							w.stats.add(playRun(cfg, *search, seed));
+						}
+					}
+				}
+
+			public:
+				std::uint64_t steals{0};
+				double seconds{0};
+
+				inline Runner(const Config& mCfg) : cfg{mCfg}
+				{
+					ssvu::clampMin(cfg.threads, 1u);
+					ssvu::clampMin(cfg.batchSize, 1u);
+					cfg.search.thinkSeconds = cfg.thinkSeconds;
+				}
+
+				inline Stats run()
+				{
+					workers.clear();
+					for(auto i(0u); i < cfg.threads; ++i) workers.emplace_back(ssvu::makeUPtr<Worker>());
+
+					// Contiguous ranges per worker keep seeds cache- and steal-friendly
+					auto batchCount((cfg.runs + cfg.batchSize - 1) / cfg.batchSize);
+					for(auto i(0u); i < batchCount; ++i)
+					{
+						auto begin(i * cfg.batchSize);
+						auto owner(i * cfg.threads / batchCount);
+						workers[owner]->batches.push_back({begin, ssvu::getClampedMax(begin + cfg.batchSize, cfg.runs)});
+					}
+
+					auto start(std::chrono::steady_clock::now());
+					{
+						std::vector<std::thread> threads;
+						for(auto i(1u); i < cfg.threads; ++i) threads.emplace_back([this, i]{ work(i); });
+						work(0);
+						for(auto& t : threads) t.join();
+					}
+					seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+					Stats result;
+					steals = 0;
+					for(auto& w : workers) { result.merge(w->stats); steals += w->steals; }
+					return result;
+				}
+		};
+	}
+}
+
+#endif
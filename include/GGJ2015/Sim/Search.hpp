@@ -0,0 +1,407 @@
+#ifndef GGJ2015_SIM_SEARCH
+#define GGJ2015_SIM_SEARCH
+
+#include <cstring>
+#include "../../GGJ2015/Core/Core.hpp"
+#include "../../GGJ2015/Sim/Policy.hpp"
+
+namespace ggj
+{
+	namespace Sim
+	{
+		struct SearchConfig
+		{
+			SizeT budget{128};			// Search iterations per decision over all threads, each expanding one node
+			SizeT threads{1};			// Independent trees merged at the root
+			int horizonRooms{8};		// Rooms played by a rollout past the room it enters
+			float exploration{0.2f};	// UCB1 exploration constant
+			SizeT scenarios{16};		// Futures drawn per run, the same for every branch, see `SearchWorker`
+			float thinkSeconds{0.5f};	// Room timer spent per key press, as in `Sim::playRun`
+		};
+
+		namespace Impl
+		{
+			/// @brief Fills `mOut` with the keys worth pressing in `mGS` and returns their count.
+			/// Creatures the player cannot damage at all (see `Creature::canDamage`) are left out.
+			inline SizeT getKeys(GameSession& mGS, int (&mOut)[Constants::maxChoices])
+			{
+				SizeT count{0};
+
+				if(mGS.currentDrops != nullptr)
+				{
+					mOut[count++] = 0;
+					for(auto i(0u); i < Constants::maxDrops; ++i)
+						if(mGS.currentDrops->has(i)) mOut[count++] = i + 1;
+
+					return count;
+				}
+
+				for(auto i(0u); i < Constants::maxChoices; ++i)
+				{
+					const auto& c(mGS.choices[i]);
+					if(c == nullptr) continue;
+
+					if(c->type == Choice::Type::Creature && !mGS.player.canDamage(static_cast<const ChoiceCreature&>(*c).creature)) continue;
+					if(c->type == Choice::Type::SingleDrop && static_cast<const ChoiceSingleDrop&>(*c).drop == nullptr) continue;
+
+					mOut[count++] = i;
+				}
+
+				return count;
+			}
+
+			/// @brief Hash of what the outcome of entering a room depends on, given the random stream
+			/// the rooms are drawn from: player stats, room number and difficulty.
+			inline std::uint64_t getRoomEntryKey(const GameSession& mGS, SizeT mScenario) noexcept
+			{
+				std::uint64_t h{mScenario};
+				auto add([&h](std::uint64_t mX){ h = (h ^ mX) * 0x9e3779b97f4a7c15ull; h ^= h >> 29; });
+
+				std::uint32_t difficultyBits;
+				std::memcpy(&difficultyBits, &mGS.difficulty, sizeof(difficultyBits));
+
+				const auto& p(mGS.player);
+				add(static_cast<std::uint64_t>(mGS.roomNumber));
+				add(difficultyBits);
+				add(static_cast<std::uint64_t>(mGS.mode));
+				add(static_cast<std::uint64_t>(p.hps));
+				add(static_cast<std::uint64_t>(p.bonusATK));
+				add(static_cast<std::uint64_t>(p.bonusDEF));
+				add(static_cast<std::uint64_t>(p.weapon.atk));
+				add(static_cast<std::uint64_t>(p.weapon.type));
+				add(p.weapon.strongAgainst.getBits() | (p.weapon.weakAgainst.getBits() << 8) | (p.armor.elementTypes.getBits() << 16));
+				add(static_cast<std::uint64_t>(p.armor.def));
+
+				return h;
+			}
+
+			/// @brief Fixed-size table of room entry values. Colliding keys replace each other.
+			class Transpositions
+			{
+				public:
+					static constexpr SizeT size{1u << 14};
+
+					struct Entry
+					{
+						std::uint64_t key;
+						float value;
+						bool valid;
+					};
+
+				private:
+					std::vector<Entry> entries;
+
+				public:
+					inline Transpositions() : entries(size, Entry{0, 0.f, false}) { }
+
+					inline void clear() noexcept { std::fill(std::begin(entries), std::end(entries), Entry{0, 0.f, false}); }
+
+					inline Entry& get(std::uint64_t mKey) noexcept
+					{
+						auto& e(entries[mKey & (size - 1)]);
+						if(e.key != mKey) e = {mKey, 0.f, false};
+						return e;
+					}
+			};
+
+			/// @brief One root-parallel search: a private session to simulate in, a private tree and
+			/// a private transposition table, so workers never share mutable state.
+			///
+			/// The tree is open-loop over the key presses of the current room, which are deterministic.
+			/// Entering the next room is a chance event, sampled from a fixed set of scenarios (seeds of
+			/// the gameplay random stream, which only room planning draws from). Every node cycles through
+			/// the scenarios as it is visited, so sibling branches are compared under the same luck.
+			/// Within a scenario, the rooms ahead only depend on the player stats the next room is entered
+			/// with: their greedy rollout is played once and kept in the transposition table.
+			class SearchWorker
+			{
+				private:
+					struct Node
+					{
+						int children[Constants::maxChoices]{-1, -1, -1, -1};	// By key, -1 if not expanded
+						float valueSum{0.f};
+						std::uint32_t visits{0};
+					};
+
+					const SearchConfig& cfg;
+					FT thinkFT;
+					GameSession gs;
+					GreedyPolicy rolloutPolicy;
+					std::vector<std::uint64_t> scenarioSeeds;
+					SizeT scenario{0};
+					Transpositions transpositions;
+					std::vector<Node> nodes;
+					std::vector<int> path;
+					int rootRoom{0};
+
+					/// @brief Presses `mKey` like `Sim::playRun` does. Returns false if the run ended.
+					inline bool press(int mKey)
+					{
+						if(gs.timerEnabled)
+						{
+							gs.timer -= thinkFT;
+							if(gs.timer <= 0) { gs.die(); return false; }
+						}
+
+						gs.executeChoice(mKey);
+
+						if(gs.player.isDead()) { gs.die(); return false; }
+						return true;
+					}
+
+					/// @brief Replaces the planned rooms, which the bot does not know, with those of scenario `mScenario`.
+					inline void setScenario(SizeT mScenario)
+					{
+						// Only the gameplay stream: forking the cosmetic one as `GameSession::seed` does is costly
+						scenario = mScenario;
+						gs.rng.seed(scenarioSeeds[mScenario]);
+						gs.discardNextRoom();
+						gs.planNextRoom();
+					}
+
+					/// @brief Value of the room just entered, in [0, 1): rooms survived by a greedy rollout
+					/// within the horizon, plus a saturating bonus for the HPS left if it survived them all.
+					inline float getRoomEntryValue()
+					{
+						auto& entry(transpositions.get(getRoomEntryKey(gs, scenario)));
+						if(entry.valid) return entry.value;
+
+						auto entryRoom(gs.roomNumber);
+						auto alive(true);
+
+						while(gs.roomNumber < entryRoom + cfg.horizonRooms)
+						{
+							auto key(rolloutPolicy.pick(gs));
+							if(key == GreedyPolicy::wait || !press(key)) { alive = false; break; }
+						}
+
+						auto hps(static_cast<float>(gs.player.hps));
+						auto value((1.f + (gs.roomNumber - entryRoom) + (alive ? hps / (hps + 100.f) : 0.f)) / (cfg.horizonRooms + 2));
+
+						entry = {entry.key, value, true};
+						return value;
+					}
+
+					/// @brief Value of a leaf: 0 if the run ends in the current room, else the value of
+					/// the next room once the greedy policy has finished the current one.
+					inline float evaluate()
+					{
+						while(gs.state == GameSession::State::Playing)
+						{
+							if(gs.roomNumber > rootRoom) return getRoomEntryValue();
+
+							auto key(rolloutPolicy.pick(gs));
+							if(key == GreedyPolicy::wait || !press(key)) break;
+						}
+
+						return 0.f;
+					}
+
+					inline int select(const Node& mNode, const int (&mKeys)[Constants::maxChoices], SizeT mKeyCount)
+					{
+						auto logVisits(std::log(static_cast<float>(mNode.visits)));
+						auto best(-1);
+						auto bestScore(-1.f);
+
+						for(auto i(0u); i < mKeyCount; ++i)
+						{
+							const auto& child(nodes[mNode.children[mKeys[i]]]);
+							auto score(child.valueSum / child.visits + cfg.exploration * std::sqrt(logVisits / child.visits));
+							if(score > bestScore) { bestScore = score; best = mKeys[i]; }
+						}
+
+						return best;
+					}
+
+					inline void iterate(const SessionSnapshot& mRoot)
+					{
+						mRoot.restore(gs);
+
+						path.clear();
+						path.emplace_back(0);
+
+						auto value(0.f);
+
+						while(true)
+						{
+							int keys[Constants::maxChoices];
+							auto keyCount(getKeys(gs, keys));
+
+							if(keyCount == 0) break;
+
+							auto nodeIdx(path.back());
+							auto unexpanded(-1);
+							for(auto i(0u); i < keyCount; ++i)
+								if(nodes[nodeIdx].children[keys[i]] == -1) { unexpanded = keys[i]; break; }
+
+							if(unexpanded != -1)
+							{
+								nodes[nodeIdx].children[unexpanded] = nodes.size();
+								path.emplace_back(nodes.size());
+								nodes.emplace_back();
+
+								setScenario(0);
+								if(press(unexpanded)) value = evaluate();
+								break;
+							}
+
+							auto key(select(nodes[nodeIdx], keys, keyCount));
+							auto childIdx(nodes[nodeIdx].children[key]);
+							path.emplace_back(childIdx);
+
+							setScenario(nodes[childIdx].visits % scenarioSeeds.size());
+							if(!press(key)) break;
+							if(gs.roomNumber > rootRoom) { value = getRoomEntryValue(); break; }
+						}
+
+						for(auto idx : path)
+						{
+							nodes[idx].valueSum += value;
+							++nodes[idx].visits;
+						}
+					}
+
+				public:
+					inline SearchWorker(const SearchConfig& mCfg) : cfg{mCfg}, thinkFT{ssvu::getSecondsToFT(mCfg.thinkSeconds)}, scenarioSeeds(mCfg.scenarios) { }
+
+					inline void reset(std::uint64_t mSeed)
+					{
+						Rng rng{mSeed};
+						for(auto& s : scenarioSeeds) s = rng();
+						transpositions.clear();
+					}
+
+					/// @brief Builds a new tree from `mRoot` with `mIterations` iterations.
+					inline void search(const SessionSnapshot& mRoot, int mRootRoom, SizeT mIterations)
+					{
+						rootRoom = mRootRoom;
+
+						nodes.clear();
+						nodes.reserve(mIterations + 1);
+						nodes.emplace_back();
+
+						for(auto i(0u); i < mIterations; ++i) iterate(mRoot);
+					}
+
+					inline std::uint32_t getRootVisits(int mKey) const noexcept
+					{
+						auto idx(nodes[0].children[mKey]);
+						return idx == -1 ? 0 : nodes[idx].visits;
+					}
+
+					inline float getRootValueSum(int mKey) const noexcept
+					{
+						auto idx(nodes[0].children[mKey]);
+						return idx == -1 ? 0.f : nodes[idx].valueSum;
+					}
+			};
+		}
+
+		/// @brief Search-based player: Monte Carlo tree search over the key presses of the current room,
+		/// with the rooms ahead sampled rather than read from the session. Root-parallel: every thread
+		/// grows its own tree for `budget / threads` iterations, and the key visited most overall wins.
+		/// The calling thread grows the first tree; the others are grown by persistent threads, which
+		/// wait between decisions. Picks only depend on the configuration, the seed and the session,
+		/// not on thread scheduling. Simulated sessions log like any other, so the event log must be disabled.
+		class SearchPolicy
+		{
+			private:
+				// Grows tree `idx` of `policy` on its own thread
+				struct Helper
+				{
+					SearchPolicy* policy;
+					SizeT idx;
+					Worker thread;
+
+					inline Helper(SearchPolicy& mPolicy, SizeT mIdx) : policy{&mPolicy}, idx{mIdx} { }
+				};
+
+				SearchConfig cfg;
+				std::vector<ssvu::UPtr<Impl::SearchWorker>> workers;
+				std::vector<ssvu::UPtr<Helper>> helpers;
+				SessionSnapshot root;
+				int rootRoom{0};
+				SizeT iterations{0};
+
+				inline void search(SizeT mIdx) { workers[mIdx]->search(root, rootRoom, iterations); }
+
+			public:
+				static constexpr int wait{GreedyPolicy::wait};
+
+				inline SearchPolicy(const SearchConfig& mCfg) : cfg{mCfg}
+				{
+					ssvu::clampMin(cfg.budget, 1u);
+					ssvu::clampMin(cfg.threads, 1u);
+					ssvu::clampMin(cfg.horizonRooms, 1);
+					ssvu::clampMin(cfg.scenarios, 1u);
+
+					for(auto i(0u); i < cfg.threads; ++i) workers.emplace_back(ssvu::makeUPtr<Impl::SearchWorker>(cfg));
+					for(auto i(1u); i < cfg.threads; ++i) helpers.emplace_back(ssvu::makeUPtr<Helper>(*this, i));
+					reset(0);
+				}
+
+				// Helpers point back to the policy
+				SearchPolicy(const SearchPolicy&) = delete;
+				SearchPolicy& operator=(const SearchPolicy&) = delete;
+
+				/// @brief Reseeds the searches and forgets the transpositions of the previous run.
+				inline void reset(std::uint64_t mSeed)
+				{
+					Rng seeder{mSeed};
+					for(auto& w : workers) w->reset(seeder());
+				}
+
+				/// @brief Returns the key (0..3) to press next, or `wait` if no key is worth pressing.
+				inline int pick(GameSession& mGS)
+				{
+					SSVU_ASSERT(!getEventLogEnabled());
+
+					if(mGS.state != GameSession::State::Playing) return wait;
+
+					int keys[Constants::maxChoices];
+					auto keyCount(Impl::getKeys(mGS, keys));
+
+					if(keyCount == 0) return wait;
+					if(keyCount == 1) return keys[0];
+
+					root.capture(mGS);
+
+					rootRoom = mGS.roomNumber;
+					iterations = (cfg.budget + cfg.threads - 1) / cfg.threads;
+
+					for(auto& h : helpers)
+						h->thread.start([](void* mX){ auto& h(*static_cast<Helper*>(mX)); h.policy->search(h.idx); }, h.get());
+
+					search(0);
+					for(auto& h : helpers) h->thread.wait();
+
+					auto best(keys[0]);
+					std::uint32_t bestVisits{0};
+					auto bestValue(0.f);
+
+					for(auto i(0u); i < keyCount; ++i)
+					{
+						std::uint32_t visits{0};
+						auto value(0.f);
+
+						for(const auto& w : workers)
+						{
+							visits += w->getRootVisits(keys[i]);
+							value += w->getRootValueSum(keys[i]);
+						}
+
+						if(visits > bestVisits || (visits == bestVisits && value > bestValue))
+						{
+							best = keys[i];
+							bestVisits = visits;
+							bestValue = value;
+						}
+					}
+
+					return best;
+				}
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,132 @@
+#include "../../GGJ2015/Core/Core.hpp"
+#include "../../GGJ2015/Sim/Runner.hpp"
+
+// Monte Carlo balancing runner.
+// Usage: ggj_sim [options] [runs per mode] [threads] [seed] [think seconds per key press]
+//        ggj_sim --replay file [playbacks], plays a recorded run back headless
+// Options: --search           play with the search bot instead of the greedy one
+//          --budget n         search iterations per decision (play strength)
+//          --search-threads n root-parallel searches per decision. Runs are already spread over
+//                             [threads], so this is clamped to cores / [threads] (at least 1)
+//          --horizon n        rooms played by search rollouts past the next room
+
+using namespace ggj;
+
+namespace
+{
+	inline const auto& getModeStr(GameSession::Mode mX)
+	{
+		static auto array(ssvu::makeArray
+		(
+			"Beginner",
+			"Official",
+			"Hardcore"
+		));
+
+		return array[static_cast<int>(mX)];
+	}
+
+	inline void printStats(GameSession::Mode mMode, const Sim::Config& mCfg, const Sim::Runner& mRunner, const Sim::Stats& mStats)
+	{
+		std::printf("== %s mode: %llu runs in %.3fs (%.0f runs/sec, %llu steals)\n", getModeStr(mMode),
+			static_cast<unsigned long long>(mStats.runs), mRunner.seconds, mStats.runs / mRunner.seconds,
+			static_cast<unsigned long long>(mRunner.steals));
+
+		std::printf("   mean room reached: %.2f\n", static_cast<double>(mStats.rooms) / mStats.runs);
+		std::printf("   key presses: %.1f per run, %.2fus each (bot and game, per thread)\n", static_cast<double>(mStats.presses) / mStats.runs,
+			1e6 * mRunner.seconds * ssvu::getClampedMin(mCfg.threads, 1u) / ssvu::getClampedMin(mStats.presses, 1u));
+
+		std::printf("   cause of death:\n");
+		for(auto i(0u); i < Sim::causeCount; ++i)
+			std::printf("     %-10s %6.2f%%\n", Sim::getCauseStr(static_cast<Sim::Cause>(i)), 100.0 * mStats.causes[i] / mStats.runs);
+
+		std::uint64_t maxCount{0};
+		for(auto c : mStats.roomHistogram) ssvu::clampMin(maxCount, c);
+
+		std::printf("   room reached:\n");
+		for(auto i(0u); i < mStats.roomHistogram.size(); ++i)
+		{
+			auto c(mStats.roomHistogram[i]);
+			if(c == 0) continue;
+
+			std::printf("     %4u %10llu %6.2f%% %s\n", i, static_cast<unsigned long long>(c), 100.0 * c / mStats.runs,
+				std::string(static_cast<SizeT>(50.0 * c / maxCount), '#').c_str());
+		}
+	}
+
+	inline int playReplayFile(const std::string& mPath, SizeT mPlaybacks)
+	{
+		RunReplay replay;
+		if(!replay.readFromFile(mPath)) { std::fprintf(stderr, "ggj_sim: cannot read replay %s\n", mPath.c_str()); return 1; }
+		ssvu::clampMin(mPlaybacks, 1u);
+
+		std::printf("ggj_sim: replay %s, %s mode, seed %llu, %zu presses over %u steps\n", mPath.c_str(), getModeStr(replay.mode),
+			static_cast<unsigned long long>(replay.seed), replay.presses.size(), replay.endTick);
+
+		ReplayResult result{0, GameSession::State::Menu, -1};
+		auto start(std::chrono::steady_clock::now());
+
+		for(auto i(0u); i < mPlaybacks; ++i)
+		{
+			GameSession gs;
+			result = playReplay(gs, replay);
+		}
+
+		auto ms(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+		std::printf("   ended in room %d (%s), %.3fms per playback\n", result.room, result.state == GameSession::State::Dead ? "dead" : "playing", ms / mPlaybacks);
+
+		if(result.divergedRoom == -1) { std::printf("   matches the recording\n"); return 0; }
+
+		std::printf("   diverged from the recording in room %d\n", result.divergedRoom);
+		return 2;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	getEventLogEnabled() = false;
+
+	if(argc > 2 && std::string{argv[1]} == "--replay") return playReplayFile(argv[2], argc > 3 ? std::stoul(argv[3]) : 1);
+
+	Sim::Config cfg;
+	std::vector<std::string> args;
+
+	for(auto i(1); i < argc; ++i)
+	{
+		std::string arg{argv[i]};
+
+		if(arg == "--search") cfg.bot = Sim::Bot::Search;
+		else if(arg == "--budget" && i + 1 < argc) cfg.search.budget = std::stoul(argv[++i]);
+		else if(arg == "--search-threads" && i + 1 < argc) cfg.search.threads = std::stoul(argv[++i]);
+		else if(arg == "--horizon" && i + 1 < argc) cfg.search.horizonRooms = std::stoi(argv[++i]);
+		else args.emplace_back(arg);
+	}
+
+	if(args.size() > 0) cfg.runs = std::stoul(args[0]);
+	if(args.size() > 1) cfg.threads = std::stoul(args[1]);
+	if(args.size() > 2) cfg.seed = std::stoull(args[2]);
+	if(args.size() > 3) cfg.thinkSeconds = std::stof(args[3]);
+
+	// Runs already keep [threads] cores busy: more search threads would only oversubscribe them
+	SizeT cores{std::thread::hardware_concurrency()};
+	auto maxSearchThreads(ssvu::getClampedMin(cores / ssvu::getClampedMin(cfg.threads, 1u), 1u));
+	if(cfg.search.threads > maxSearchThreads)
+	{
+		std::printf("ggj_sim: --search-threads %zu clamped to %zu, as %zu runs are played in parallel\n", cfg.search.threads, maxSearchThreads, cfg.threads);
+		cfg.search.threads = maxSearchThreads;
+	}
+
+	std::printf("ggj_sim: %zu runs per mode, %zu threads, seed %llu\n", cfg.runs, cfg.threads, static_cast<unsigned long long>(cfg.seed));
+	if(cfg.bot == Sim::Bot::Search)
+		std::printf("   search bot: %zu iterations per decision, %zu threads per decision\n", cfg.search.budget, cfg.search.threads);
+
+	for(auto m : {GameSession::Mode::Beginner, GameSession::Mode::Official, GameSession::Mode::Hardcore})
+	{
+		cfg.mode = m;
+		Sim::Runner runner{cfg};
+		auto stats(runner.run());
+		printStats(m, cfg, runner, stats);
+	}
+
+	return 0;
+}
@@ -0,0 +1,534 @@
+#include <atomic>
+#include <sstream>
+#include <thread>
+#include "../../GGJ2015/Core/Core.hpp"
+
+// Tests of the headless core, run by `ctest` (or directly: ggj_tests).
+
+namespace
+{
+	inline auto& getFailureCount() noexcept { static std::atomic<int> result{0}; return result; }
+}
+
+// Reports failures through SSVUT like `SSVUT_EXPECT`, and also counts them: SSVUT does not turn
+// them into an exit status, which `ctest` needs.
+#define GGJ_EXPECT(mX) do { if(!(mX)) { ++getFailureCount(); SSVUT_EXPECT(false && #mX); } } while(false)
+
+SSVUT_TEST(FightResolverMatchesTurnLoop)
+{
+	using namespace ggj;
+
+	// Reference implementation: the original float damage formula and turn-by-turn loop
+	auto refDamage([](const Creature& mA, const Creature& mB)
+	{
+		auto result((mA.weapon.atk + mA.bonusATK) - (mB.armor.def + mB.bonusDEF));
+		if(Calculations::isWeaponStrongAgainst(mA.weapon, mB.armor)) result *= Constants::bonusMultiplier;
+		if(Calculations::isWeaponWeakAgainst(mA.weapon, mB.armor)) result *= Constants::malusMultiplier;
+		return ssvu::getClampedMin(result, 0);
+	});
+
+	auto refFight([&refDamage](Creature& mA, Creature& mB)
+	{
+		while(true)
+		{
+			mB.hps -= refDamage(mA, mB);
+			if(mB.isDead()) break;
+
+			mA.hps -= refDamage(mB, mA);
+			if(mA.isDead()) break;
+		}
+	});
+
+	Rng rng{1234};
+	auto rndElems([&rng]{ return ElementBitset(rng.getRnd(0, 16)); });
+	auto rndCreature([&](int mMax)
+	{
+		Creature c;
+		c.hps = rng.getRnd(-5, mMax * 10);
+		c.bonusATK = rng.getRnd(0, mMax / 4 + 1);
+		c.bonusDEF = rng.getRnd(0, mMax / 4 + 1);
+		c.weapon.atk = rng.getRnd(0, mMax);
+		c.weapon.strongAgainst = rndElems();
+		c.weapon.weakAgainst = rndElems();
+		c.armor.def = rng.getRnd(0, mMax);
+		c.armor.elementTypes = rndElems();
+		return c;
+	});
+
+	auto prevLog(getEventLogEnabled());
+	getEventLogEnabled() = false;
+
+	for(auto i(0); i < 200000; ++i)
+	{
+		auto a(rndCreature(i % 2 == 0 ? 30 : 3000)), b(rndCreature(i % 2 == 0 ? 30 : 3000));
+
+		GGJ_EXPECT(a.getDamageAgainst(b) == refDamage(a, b));
+		GGJ_EXPECT(b.getDamageAgainst(a) == refDamage(b, a));
+
+		// The original loop never terminates if nobody can deal damage
+		if(refDamage(a, b) == 0 && refDamage(b, a) == 0) continue;
+
+		auto refA(a), refB(b);
+		refFight(refA, refB);
+		a.fight(b);
+
+		GGJ_EXPECT(a.hps == refA.hps);
+		GGJ_EXPECT(b.hps == refB.hps);
+	}
+
+	getEventLogEnabled() = prevLog;
+}
+
+SSVUT_TEST(BatchKernelsMatchCreatureFights)
+{
+	using namespace ggj;
+
+	Rng rng{4321};
+	auto rndElems([&rng]{ return ElementBitset(rng.getRnd(0, 16)); });
+	auto rndCreature([&](int mMax)
+	{
+		Creature c;
+		c.hps = rng.getRnd(-5, mMax * 10);
+		c.bonusATK = rng.getRnd(0, mMax / 4 + 1);
+		c.bonusDEF = rng.getRnd(0, mMax / 4 + 1);
+		c.weapon.atk = rng.getRnd(0, mMax);
+		c.weapon.strongAgainst = rndElems();
+		c.weapon.weakAgainst = rndElems();
+		c.armor.def = rng.getRnd(0, mMax);
+		c.armor.elementTypes = rndElems();
+		return c;
+	});
+
+	auto prevLog(getEventLogEnabled());
+	getEventLogEnabled() = false;
+
+	// Sizes that are not multiples of the vector widths, so that every scalar tail runs too
+	for(auto size : {1u, 3u, 7u, 13u, 1021u})
+	{
+		std::vector<Creature> as, bs;
+		CreatureBatch batchA, batchB;
+
+		for(auto i(0u); i < size; ++i)
+		{
+			as.emplace_back(rndCreature(i % 2 == 0 ? 30 : 3000));
+			bs.emplace_back(rndCreature(i % 2 == 0 ? 30 : 3000));
+			batchA.push(as.back());
+			batchB.push(bs.back());
+		}
+
+		for(auto k(0); k <= static_cast<int>(getBestBatchKernel()); ++k)
+		{
+			auto kernel(static_cast<BatchKernel>(k));
+
+			std::vector<HPS> damage(size);
+			computeBatchDamage(batchA, batchB, damage.data(), kernel);
+			for(auto i(0u); i < size; ++i) GGJ_EXPECT(damage[i] == as[i].getDamageAgainst(bs[i]));
+
+			auto a(batchA), b(batchB);
+			resolveBatchFights(a, b, kernel);
+
+			for(auto i(0u); i < size; ++i)
+			{
+				auto refA(as[i]), refB(bs[i]);
+				refA.fight(refB);
+
+				GGJ_EXPECT(a.hps[i] == refA.hps);
+				GGJ_EXPECT(b.hps[i] == refB.hps);
+			}
+		}
+	}
+
+	getEventLogEnabled() = prevLog;
+}
+
+SSVUT_TEST(WeightedTablesMatchWeights)
+{
+	using namespace ggj;
+
+	auto check([](const auto& mTable)
+	{
+		constexpr int samples{200000};
+		constexpr auto size(std::decay_t<decltype(mTable)>::size());
+
+		// Encoded probabilities match the weights
+		for(auto i(0u); i < size; ++i)
+			GGJ_EXPECT(std::abs(mTable.getProbability(i) - mTable.getExpectedProbability(i)) < 1e-6);
+
+		// Sampled distribution passes a chi-square goodness-of-fit test at p = 0.001
+		Rng rng{5678};
+		int counts[size]{};
+
+		for(auto i(0); i < samples; ++i)
+		{
+			const auto& x(mTable.get(rng));
+			++counts[&x - &mTable.values[0]];
+		}
+
+		double chiSquare{0};
+		for(auto i(0u); i < size; ++i)
+		{
+			auto expected(samples * mTable.getExpectedProbability(i));
+			chiSquare += (counts[i] - expected) * (counts[i] - expected) / expected;
+		}
+
+		// Wilson-Hilferty approximation of the critical value
+		double df(size - 1), h(2.0 / (9.0 * df));
+		auto critical(df * std::pow(1.0 - h + 3.09 * std::sqrt(h), 3));
+
+		GGJ_EXPECT(chiSquare < critical);
+	});
+
+	check(getGen().getWeapons());
+	check(getGen().getItemModifiers());
+	check(getGen().getCreatures());
+	check(getGen().getCreatureModifier());
+	check(getGen().getChoiceTypes());
+	check(getGen().getDropTypes());
+}
+
+SSVUT_TEST(PoolsRecycleChoicesAndDrops)
+{
+	using namespace ggj;
+
+	auto& logEnabled(getEventLogEnabled());
+	auto wasLogEnabled(logEnabled);
+	logEnabled = false;
+
+	// Every object handed out is either reachable from the session or back in its pool
+	GameSession gs;
+	gs.seed(91);
+
+	for(int run{0}; run < 50; ++run)
+	{
+		gs.restart();
+
+		for(int step{0}; step < 2000 && gs.state == GameSession::State::Playing; ++step)
+		{
+			if(gs.player.isDead()) { gs.die(); break; }
+			gs.executeChoice(step % 4);
+
+			for(const auto& g : gs.roomGens)
+			{
+				GGJ_EXPECT(g.choicePool.getLiveCount() <= 2 * Constants::maxChoices);
+				GGJ_EXPECT(g.dropPool.getLiveCount() <= 2 * Constants::maxChoices * Constants::maxDrops);
+			}
+		}
+	}
+
+	gs.discardNextRoom();
+	gs.endDrops();
+	for(auto& c : gs.choices) c.reset();
+	for(auto& c : gs.nextChoices) c.reset();
+
+	for(const auto& g : gs.roomGens)
+	{
+		GGJ_EXPECT(g.choicePool.getLiveCount() == 0);
+		GGJ_EXPECT(g.dropPool.getLiveCount() == 0);
+	}
+
+	logEnabled = wasLogEnabled;
+}
+
+SSVUT_TEST(PregeneratedRoomsMatchSynchronousOnes)
+{
+	using namespace ggj;
+
+	auto& logEnabled(getEventLogEnabled());
+	auto wasLogEnabled(logEnabled);
+	logEnabled = false;
+
+	// Rooms generated ahead on a worker must be the ones `advance` would have generated
+	GameSession sync, async;
+	async.pregenerate = true;
+
+	auto getRoomStr([](GameSession& mGS)
+	{
+		std::string result;
+		for(const auto& c : mGS.choices)
+		{
+			if(c == nullptr) { result += "-"; continue; }
+
+			result += c->getChoiceStr();
+			if(c->type == Choice::Type::Creature) result += ssvu::toStr(static_cast<const ChoiceCreature&>(*c).creature.hps);
+		}
+
+		return result + ssvu::toStr(mGS.player.hps);
+	});
+
+	for(auto s : {3u, 17u, 4242u})
+	{
+		sync.seed(s);
+		async.seed(s);
+		sync.restart();
+		async.restart();
+
+		for(int step{0}; step < 500 && sync.state == GameSession::State::Playing; ++step)
+		{
+			GGJ_EXPECT(getRoomStr(sync) == getRoomStr(async));
+
+			if(sync.player.isDead()) break;
+			sync.executeChoice(step * 7 % 4);
+			async.executeChoice(step * 7 % 4);
+		}
+	}
+
+	logEnabled = wasLogEnabled;
+}
+
+SSVUT_TEST(SnapshotsRestoreSessionsExactly)
+{
+	using namespace ggj;
+
+	auto& logEnabled(getEventLogEnabled());
+	auto wasLogEnabled(logEnabled);
+	logEnabled = false;
+
+	auto getSessionStr([](GameSession& mGS)
+	{
+		std::string result{ssvu::toStr(mGS.roomNumber) + " " + ssvu::toStr(mGS.player.hps) + " " + ssvu::toStr(mGS.player.bonusATK)};
+		result += mGS.currentDrops == nullptr ? " -" : " drops";
+
+		for(const auto& c : mGS.choices)
+		{
+			if(c == nullptr) { result += " -"; continue; }
+
+			result += " " + c->getChoiceStr();
+			if(c->type == Choice::Type::Creature) result += ssvu::toStr(static_cast<const ChoiceCreature&>(*c).creature.hps);
+		}
+
+		return result;
+	});
+
+	// A session restored from a snapshot taken mid-run must play on exactly like the original
+	GameSession original, restored;
+	SessionSnapshot snapshot;
+
+	for(auto s : {5u, 23u, 777u})
+	{
+		original.seed(s);
+		original.restart();
+
+		for(int step{0}; step < 40 && !original.player.isDead(); ++step) original.executeChoice(step * 3 % 4);
+
+		snapshot.capture(original);
+		GGJ_EXPECT(snapshot.getSize() < 1024);
+		GGJ_EXPECT(snapshot.restore(restored));
+
+		for(int step{0}; step < 300 && !original.player.isDead(); ++step)
+		{
+			GGJ_EXPECT(getSessionStr(original) == getSessionStr(restored));
+			original.executeChoice(step * 5 % 4);
+			restored.executeChoice(step * 5 % 4);
+		}
+	}
+
+	// Snapshots from another version are rejected
+	std::vector<std::uint8_t> bytes(snapshot.getData(), snapshot.getData() + snapshot.getSize());
+	bytes[4] = 99;
+
+	SessionSnapshot bad;
+	GGJ_EXPECT(bad.readFromBuffer(bytes.data(), bytes.size()));
+	GGJ_EXPECT(!bad.restore(restored));
+	GGJ_EXPECT(restored.state == GameSession::State::Menu);
+
+	logEnabled = wasLogEnabled;
+}
+
+SSVUT_TEST(ReplaysPlayBackRecordedRuns)
+{
+	using namespace ggj;
+
+	auto& logEnabled(getEventLogEnabled());
+	auto wasLogEnabled(logEnabled);
+	logEnabled = false;
+
+	// Advances when possible, otherwise picks anything else up, otherwise fights
+	auto getKey([](const GameSession& mGS)
+	{
+		int result{0}, rank{-1};
+
+		for(auto i(0u); i < Constants::maxChoices && mGS.currentDrops == nullptr; ++i)
+		{
+			if(mGS.choices[i] == nullptr) continue;
+
+			auto type(mGS.choices[i]->type);
+			int r(type == Choice::Type::Advance ? 2 : type == Choice::Type::Creature ? 0 : 1);
+			if(r > rank) { rank = r; result = i; }
+		}
+
+		return result;
+	});
+
+	// Records a run driven like the game loop: bursts of key presses every few timer steps, so
+	// that some steps cross more than one room
+	GameSession gs;
+	ReplayRecorder recorder;
+	recorder.begin(gs, GameSession::Mode::Official, 1234);
+	int maxRoomsPerStep{0};
+
+	for(std::uint32_t tick{0}; recorder.isRecording(); ++tick)
+	{
+		auto room(gs.roomNumber);
+
+		if(tick % 37 == 0)
+			for(int i{0}; i < 8 && gs.state == GameSession::State::Playing; ++i)
+				recorder.execute(gs, getKey(gs));
+
+		maxRoomsPerStep = std::max(maxRoomsPerStep, gs.roomNumber - room);
+
+		gs.updateTimer(0.5f);
+		recorder.endTick(gs, 0.5f);
+	}
+
+	auto replay(recorder.getReplay());
+	GGJ_EXPECT(maxRoomsPerStep >= 2);
+	GGJ_EXPECT(replay.roomChecksums.size() == static_cast<SizeT>(gs.roomNumber));
+	auto bytes(replay.writeToBuffer());
+
+	RunReplay loaded;
+	GGJ_EXPECT(loaded.readFromBuffer(bytes.data(), bytes.size()));
+
+	GameSession played;
+	auto result(playReplay(played, loaded));
+	GGJ_EXPECT(result.room == gs.roomNumber && result.state == gs.state && result.divergedRoom == -1);
+	GGJ_EXPECT(getChecksum(played) == getChecksum(gs));
+
+	// A recording that does not match the game is detected in the first room that differs
+	if(loaded.roomChecksums.size() > 2)
+	{
+		loaded.roomChecksums[2] ^= 1;
+		GGJ_EXPECT(playReplay(played, loaded).divergedRoom == 3);
+	}
+
+	logEnabled = wasLogEnabled;
+}
+
+SSVUT_TEST(EventLogBufferKeepsLastLines)
+{
+	using namespace ggj;
+
+	EventLogBuffer elb;
+	std::ostream os{&elb};
+
+	for(int i{0}; i < 100; ++i) os << "Line " << i << "\n";
+	os << std::string(EventLogBuffer::lineLength * 2, 'x') << "\n";
+
+	GGJ_EXPECT(elb.getGeneration() == 101);
+	GGJ_EXPECT(elb.getLineCount() == EventLogBuffer::lineCount - 1);
+
+	std::string tail;
+	elb.forLastLines(3, [&tail](const char* mLine, SizeT mLength){ tail.append(mLine, mLength); tail += '\n'; });
+	GGJ_EXPECT(tail == "Line 98\nLine 99\n" + std::string(EventLogBuffer::lineLength, 'x') + "\n");
+}
+
+SSVUT_TEST(ProfilerKeepsLastFrames)
+{
+	using namespace ggj;
+	using namespace ggj::Profiler;
+
+	FrameProfiler fp;
+
+	for(int i{1}; i <= 100; ++i)
+	{
+		fp.add(Phase::Fight, std::chrono::milliseconds(i));
+		fp.endFrame();
+	}
+
+	auto stats(fp.getStats(Phase::Fight));
+	GGJ_EXPECT(fp.getFrameCount() == 100);
+	GGJ_EXPECT(stats.min == 1.f && stats.avg == 50.5f && stats.p99 == 99.f);
+
+	for(auto i(0u); i < frameCount; ++i) fp.endFrame();
+	GGJ_EXPECT(fp.getFrameCount() == frameCount);
+	GGJ_EXPECT(fp.getStats(Phase::Fight).p99 == 0.f);
+
+	std::ostringstream os;
+	fp.dumpCSV(os);
+	auto csv(os.str());
+	GGJ_EXPECT(std::count(std::begin(csv), std::end(csv), '\n') == static_cast<long>(frameCount) + 1);
+}
+
+SSVUT_TEST(SessionViewsCrossThreads)
+{
+	using namespace ggj;
+
+	// Items pushed on one thread are popped in order on another, none lost or repeated
+	// Consumers yield when there is nothing to take, so that the test also runs on a single core
+	SPSCQueue<int, 16> queue;
+	constexpr int itemCount{500};
+
+	std::thread producer{[&queue]{ for(int i{1}; i <= itemCount; ++i) while(!queue.tryPush(i)) std::this_thread::yield(); }};
+
+	int expected{1}, item;
+	while(expected <= itemCount)
+	{
+		if(queue.tryPop(item)) GGJ_EXPECT(item == expected++);
+		else std::this_thread::yield();
+	}
+
+	producer.join();
+	GGJ_EXPECT(queue.isEmpty());
+
+	// The reader only ever sees whole values, published in order
+	struct Pair { int a{0}, b{0}; };
+	TripleBuffer<Pair> pairs;
+
+	std::thread writer{[&pairs]
+	{
+		for(int i{1}; i <= itemCount; ++i)
+		{
+			auto& p(pairs.getBack());
+			p.a = i;
+			p.b = -i;
+			pairs.publish();
+		}
+	}};
+
+	int last{0};
+	while(last < itemCount)
+	{
+		if(!pairs.update()) { std::this_thread::yield(); continue; }
+
+		const auto& p(pairs.getFront());
+		GGJ_EXPECT(p.a == -p.b && p.a > last);
+		last = p.a;
+	}
+
+	writer.join();
+
+	// A captured view matches the session it was built from, and the tail of the given log
+	auto& logEnabled(getEventLogEnabled());
+	auto wasLogEnabled(logEnabled);
+	logEnabled = false;
+
+	GameSession gs;
+	gs.seed(64);
+	gs.restart();
+	for(int step{0}; step < 20 && !gs.player.isDead(); ++step) gs.executeChoice(step % 4);
+
+	EventLogBuffer elb;
+	std::ostream os{&elb};
+	for(int i{0}; i < 8; ++i) os << "Line " << i << "\n";
+
+	SessionView view;
+	view.capture(gs, elb);
+
+	GGJ_EXPECT(view.state == gs.state && view.roomNumber == gs.roomNumber && view.player.hps == gs.player.hps);
+	GGJ_EXPECT((view.dropsID != nullptr) == (gs.currentDrops != nullptr));
+
+	for(auto i(0u); i < Constants::maxChoices; ++i)
+	{
+		GGJ_EXPECT(view.hasChoice[i] == (gs.choices[i] != nullptr));
+		if(view.hasChoice[i]) GGJ_EXPECT(getChoiceLabel(view.choices[i].type) == gs.choices[i]->getChoiceStr());
+	}
+
+	GGJ_EXPECT(std::string(view.log, view.logSize) == "Line 3\nLine 4\nLine 5\nLine 6\nLine 7\n");
+
+	logEnabled = wasLogEnabled;
+}
+
+int main()
+{
+	SSVUT_RUN();
+	return getFailureCount() == 0 ? 0 : 1;
+}
@@ -0,0 +1,99 @@
+#ifndef GGJ2015_VOICEPOOL
+#define GGJ2015_VOICEPOOL
+
+#include "../GGJ2015/Common.hpp"
+
+namespace ggj
+{
+	/// @brief Sound effect categories, lowest priority first. Music does not go through the pool:
+	/// it has its own streams (see `MusicStreamer`), so it can never be stolen.
+	enum class VoiceCategory : int {UI = 0, Attack = 1, Lose = 2};
+
+	/// @brief Fixed set of sound sources shared by every sound effect. When all voices are busy,
+	/// a new sound steals the oldest voice of the lowest category not above its own; if there
+	/// is none, it is dropped. The number of sources in use is therefore bounded, however
+	/// many sounds are requested.
+	class VoicePool
+	{
+		public:
+			static constexpr SizeT voiceCount{16};
+
+			enum class Mode : int
+			{
+				Override = 0,	// Restarts a voice already playing the same buffer, if any
+				Overlap = 1		// Always uses another voice
+			};
+
+		private:
+			struct Voice
+			{
+				sf::Sound sound;
+				VoiceCategory category{VoiceCategory::UI};
+				std::uint64_t startTime{0};
+			};
+
+			std::array<Voice, voiceCount> voices;
+			std::uint64_t time{0};
+			std::uint64_t droppedCount{0}, stolenCount{0};
+			float volume{100.f};
+
+			inline static bool isPlaying(const Voice& mX) { return mX.sound.getStatus() == sf::Sound::Playing; }
+
+			inline Voice* acquire(const sf::SoundBuffer& mBuffer, VoiceCategory mCategory, Mode mMode)
+			{
+				if(mMode == Mode::Override)
+					for(auto& v : voices)
+						if(isPlaying(v) && v.sound.getBuffer() == &mBuffer) return &v;
+
+				Voice* victim{nullptr};
+
+				for(auto& v : voices)
+				{
+					if(!isPlaying(v)) return &v;
+					if(v.category > mCategory) continue;
+
+					if(victim == nullptr || v.category < victim->category || (v.category == victim->category && v.startTime < victim->startTime))
+						victim = &v;
+				}
+
+				if(victim == nullptr) ++droppedCount;
+				else ++stolenCount;
+
+				return victim;
+			}
+
+		public:
+			inline void play(const sf::SoundBuffer& mBuffer, VoiceCategory mCategory, Mode mMode = Mode::Override, float mPitch = 1.f)
+			{
+				auto* voice(acquire(mBuffer, mCategory, mMode));
+				if(voice == nullptr) return;
+
+				voice->sound.stop();
+				voice->sound.setBuffer(mBuffer);
+				voice->sound.setPitch(mPitch);
+				voice->sound.setVolume(volume);
+				voice->category = mCategory;
+				voice->startTime = ++time;
+				voice->sound.play();
+			}
+
+			inline void stop() { for(auto& v : voices) v.sound.stop(); }
+
+			inline void setVolume(float mX) noexcept { volume = mX; }
+
+			inline SizeT getActiveCount() const
+			{
+				SizeT result{0};
+				for(const auto& v : voices) if(isPlaying(v)) ++result;
+				return result;
+			}
+
+			/// @brief Sounds not played because every voice was busy with a higher category.
+			inline std::uint64_t getDroppedCount() const noexcept { return droppedCount; }
+
+			/// @brief Sounds played by cutting another one short.
+			inline std::uint64_t getStolenCount() const noexcept { return stolenCount; }
+	};
+}
+
+#endif
@@ -1,5 +1,12 @@
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "../GGJ2015/Common.hpp"
 #include "../GGJ2015/Boilerplate.hpp"
+#include "../GGJ2015/AssetLoader.hpp"
+#include "../GGJ2015/MusicStreamer.hpp"
+#include "../GGJ2015/VoicePool.hpp"
+#include "../GGJ2015/Core/Core.hpp"
 
 // TODO: better resource caching system in SSVS
 // TODO: load resources from folder, not json?
@@ -7,35 +14,26 @@
 // TODO: rich bitmap text
 // TODO: game state virtual funcs
 
-#define CACHE_ASSET(mType, mName, mExt) mType* mName{&assetLoader.assetManager.get<mType>(SSVPP_TOSTR(mName) mExt)}
+#define CACHE_FONT(mName) ssvs::BitmapFont* mName{&assetLoader.getFont(SSVPP_TOSTR(mName))}
+#define CACHE_ASSET(mType, mName, mExt) AssetHandle<mType> mName{assetLoader.get<mType>(SSVPP_TOSTR(mName) mExt)}
 
 namespace ggj
 {
-	class GameSession;
-
 	namespace Impl
 	{
-		struct AssetLoader
-		{
-			ssvs::AssetManager assetManager;
-
-			inline AssetLoader()
-			{
-				ssvs::loadAssetsFromJson(assetManager, "Data/", ssvj::Val::fromFile("Data/assets.json"));
-			}
-		};
-
 		struct Assets
 		{
-			AssetLoader assetLoader{};
+			// Fonts are loaded before the constructor returns, which is all the menu needs.
+			// Everything else is loaded by group; music is streamed (see `AudioObserver`).
+			AsyncAssetLoader assetLoader{"Data/"};
 
 			// Audio players
-			ssvs::SoundPlayer soundPlayer;
+			VoicePool voices;
 			ssvs::MusicPlayer musicPlayer;
 
 			// BitmapFonts
-			CACHE_ASSET(ssvs::BitmapFont, fontObStroked, "");
-			CACHE_ASSET(ssvs::BitmapFont, fontObBig, "");
+			CACHE_FONT(fontObStroked);
+			CACHE_FONT(fontObBig);
 
 			// Textures
 			CACHE_ASSET(sf::Texture, slotChoice, ".png");
@@ -63,11 +61,6 @@ namespace ggj
 			CACHE_ASSET(sf::Texture, armDrop, ".png");
 
 			// Sounds
-			CACHE_ASSET(sf::SoundBuffer, lvl1, ".wav");
-			CACHE_ASSET(sf::SoundBuffer, lvl2, ".wav");
-			CACHE_ASSET(sf::SoundBuffer, lvl3, ".wav");
-			CACHE_ASSET(sf::SoundBuffer, lvl4, ".wav");
-			CACHE_ASSET(sf::SoundBuffer, menu, ".wav");
 			CACHE_ASSET(sf::SoundBuffer, powerup, ".wav");
 			CACHE_ASSET(sf::SoundBuffer, drop, ".wav");
 			CACHE_ASSET(sf::SoundBuffer, grab, ".wav");
@@ -75,7 +68,10 @@ namespace ggj
 			CACHE_ASSET(sf::SoundBuffer, equipWpn, ".wav");
 			CACHE_ASSET(sf::SoundBuffer, lose, ".wav");
 
-			std::vector<sf::SoundBuffer*> swordSnds, maceSnds, spearSnds;
+			std::vector<AssetHandle<sf::SoundBuffer>> swordSnds, maceSnds, spearSnds;
+
+			// All sprite textures (not the bitmap fonts), packed for `Boilerplate::SpriteBatch`
+			Boilerplate::TextureAtlas atlas;
 
 			inline Assets()
 			{
@@ -83,414 +79,429 @@ namespace ggj
 
 				for(auto& e : elems)
 				{
-					swordSnds.emplace_back(&assetLoader.assetManager.get<sf::SoundBuffer>("sword/" + e + ".wav"));
-					maceSnds.emplace_back(&assetLoader.assetManager.get<sf::SoundBuffer>("mace/" + e + ".wav"));
-					spearSnds.emplace_back(&assetLoader.assetManager.get<sf::SoundBuffer>("spear/" + e + ".wav"));
+					swordSnds.emplace_back(assetLoader.get<sf::SoundBuffer>("sword/" + e + ".wav"));
+					maceSnds.emplace_back(assetLoader.get<sf::SoundBuffer>("mace/" + e + ".wav"));
+					spearSnds.emplace_back(assetLoader.get<sf::SoundBuffer>("spear/" + e + ".wav"));
 				}
 
-				soundPlayer.setVolume(100.f);
+				voices.setVolume(100.f);
+
+				assetLoader.whenResident("gameplayUI", [this]
+				{
+					atlas.build
+					({
+						slotChoice.get(), iconHPS.get(), iconATK.get(), iconDEF.get(), drops.get(), enemy.get(),
+						blocked.get(), back.get(), dropsModal.get(), advance.get(), itemCard.get(), eFire.get(),
+						eWater.get(), eEarth.get(), eLightning.get(), eST.get(), eWK.get(), eTY.get(),
+						equipCard.get(), wpnMace.get(), wpnSword.get(), wpnSpear.get(), armDrop.get()
+					});
+				});
+			}
+
+			// Everything needed to start a session
+			inline bool isGameplayResident() const
+			{
+				return assetLoader.isResident("gameplayUI") && assetLoader.isResident("weaponSFX");
 			}
 		};
 	}
 
 	inline auto& getAssets() noexcept { static Impl::Assets result; return result; }
-	inline auto& getEventLogStream() noexcept { static std::stringstream result; return result; }
 
 	inline auto mkTxtOBSmall()	{ ssvs::BitmapText result{*getAssets().fontObStroked};	result.setTracking(-3); return result; }
 	inline auto mkTxtOBBig()	{ ssvs::BitmapText result{*getAssets().fontObBig};		result.setTracking(-1); return result; }
 
-	template<typename TArg, typename... TArgs> inline auto mkShuffledVector(TArg&& mArg, TArgs&&... mArgs)
+	// Shared glyph geometry for labels drawn in many places: each distinct string is laid out once,
+	// centered on its origin, and placed through the render states instead of being rebuilt.
+	class LabelCache
 	{
-		std::vector<TArg> result;
-		result.emplace_back(ssvu::fwd<TArg>(mArg));
-		ssvu::forArgs([&result](auto&& mX){ result.emplace_back(ssvu::fwd<decltype(mX)>(mX)); }, ssvu::fwd<TArgs>(mArgs)...);
-		ssvu::shuffle(result);
-		return result;
-	}
+		private:
+			ssvs::BitmapText prototype;
+			std::map<std::string, ssvs::BitmapText> labels;
 
-	namespace Impl
-	{
-		struct EventLog
-		{
-			template<typename T> inline auto operator<<(const T& mX)
+		public:
+			inline LabelCache(ssvs::BitmapText mPrototype) : prototype{std::move(mPrototype)} { }
+
+			inline const auto& get(const std::string& mStr)
 			{
-				getEventLogStream() << mX;
-				ssvu::lo() << mX;
-				return EventLog{};
+				auto itr(labels.find(mStr));
+				if(itr != std::end(labels)) return itr->second;
+
+				auto txt(prototype);
+				txt.setString(mStr);
+				ssvs::setOrigin(txt, ssvs::getLocalCenter);
+				return labels.emplace(mStr, std::move(txt)).first->second;
 			}
-		};
-	}
 
-	inline auto eventLo() noexcept { return Impl::EventLog{}; }
+			template<typename TTarget> inline void draw(TTarget& mTarget, const std::string& mStr, const Vec2f& mPos)
+			{
+				sf::RenderStates states;
+				states.transform.translate(mPos);
+				Boilerplate::draw(mTarget, get(mStr), states);
+			}
+	};
 
-	using StatType = int;
-	using HPS = StatType;
-	using ATK = StatType;
-	using DEF = StatType;
+	inline auto& getSmallLabels() noexcept { static LabelCache result{mkTxtOBSmall()}; return result; }
+	inline auto& getBigLabels() noexcept { static LabelCache result{ssvs::BitmapText{*getAssets().fontObBig}}; return result; }
 
-	struct Constants
+	inline auto& getWeaponTypeTexture(const Weapon& mW)
 	{
-		static constexpr SizeT elementCount{4};
-		static constexpr SizeT maxChoices{4};
-		static constexpr SizeT maxDrops{3};
-		static constexpr float bonusMultiplier{2.5f};
-		static constexpr float malusMultiplier{0.8f};
-	};
+		static auto array(ssvu::makeArray
+		(
+			getAssets().wpnMace,
+			getAssets().wpnSword,
+			getAssets().wpnSpear
+		));
+
+		return *array[static_cast<int>(mW.type)];
+	}
+
+	inline auto& getWeaponTypeSoundBufferVec(const Weapon& mW)
+	{
+		static auto array(ssvu::makeArray
+		(
+			getAssets().maceSnds,
+			getAssets().swordSnds,
+			getAssets().spearSnds
+		));
 
-	using ElementBitset = std::bitset<Constants::elementCount>;
+		return array[static_cast<int>(mW.type)];
+	}
 
-	struct Weapon
+	inline void playWeaponAttackSounds(const Weapon& mW)
 	{
-		enum class Type : int {Mace = 0 , Sword = 1, Spear = 2};
+		auto& vec(getWeaponTypeSoundBufferVec(mW));
+
+		// Normal
+		if(mW.strongAgainst.none())
+		{
+			getAssets().voices.play(*vec[0], VoiceCategory::Attack);
+		}
+		else
+		{
+			for(auto i(0u); i < Constants::elementCount; ++i)
+			{
+				if(mW.strongAgainst[i]) getAssets().voices.play(*vec[i + 1], VoiceCategory::Attack);
+			}
+		}
+	}
 
-		std::string name{"Unarmed"};
-		ElementBitset strongAgainst;
-		ElementBitset weakAgainst;
-		ATK atk{-1};
-		Type type{Type::Mace};
+	// Plays the sounds and music requested by a `GameSession`.
+	struct AudioObserver : public SessionObserver
+	{
+		MusicStreamer music;
 
-		inline auto& getTypeTexture()
+		inline static const auto& getMusicID(MusicID mID)
 		{
 			static auto array(ssvu::makeArray
 			(
-				getAssets().wpnMace,
-				getAssets().wpnSword,
-				getAssets().wpnSpear
+				"menu.wav",
+				"lvl1.wav",
+				"lvl2.wav",
+				"lvl3.wav",
+				"lvl4.wav"
 			));
 
-			return *array[static_cast<int>(type)];
+			return array[static_cast<int>(mID)];
 		}
 
-		inline auto& getTypeSoundBufferVec()
+		inline auto& getSoundBuffer(SoundID mID)
 		{
 			static auto array(ssvu::makeArray
 			(
-				getAssets().maceSnds,
-				getAssets().swordSnds,
-				getAssets().spearSnds
+				getAssets().powerup,
+				getAssets().drop,
+				getAssets().grab,
+				getAssets().equipArmor,
+				getAssets().equipWpn,
+				getAssets().lose
 			));
 
-			return array[static_cast<int>(type)];
+			return *array[static_cast<int>(mID)];
 		}
 
-		inline void playAttackSounds()
+		inline void onPlaySound(SoundID mID) override
 		{
-			auto& vec(getTypeSoundBufferVec());
+			GGJ_PROFILE_SCOPE(Audio);
 
-			// Normal
-			if(strongAgainst.none())
-			{
-				getAssets().soundPlayer.play(*vec[0]);
-			}
+			auto category(mID == SoundID::Lose ? VoiceCategory::Lose : VoiceCategory::UI);
+
+			if(mID == SoundID::Powerup)
+				getAssets().voices.play(getSoundBuffer(mID), category, VoicePool::Mode::Overlap, 1.8f);
 			else
-			{
-				for(auto i(0u); i < Constants::elementCount; ++i)
-				{
-					if(strongAgainst[i]) getAssets().soundPlayer.play(*vec[i + 1]);
-				}
-			}
+				getAssets().voices.play(getSoundBuffer(mID), category);
 		}
-	};
 
-	struct Armor
-	{
-		std::string name{"Unarmored"};
-		ElementBitset elementTypes;
-		DEF def{-1};
-	};
+		inline void onPlayAttack(const Weapon& mW) override { GGJ_PROFILE_SCOPE(Audio); playWeaponAttackSounds(mW); }
 
-	struct Calculations
-	{
-		inline static bool isWeaponStrongAgainst(const Weapon& mW, const Armor& mA)
+		inline void onRefreshMusic(MusicID mID) override
 		{
-			return (mW.strongAgainst & mA.elementTypes).any();
-		}
+			GGJ_PROFILE_SCOPE(Audio);
 
-		inline static bool isWeaponWeakAgainst(const Weapon& mW, const Armor& mA)
-		{
-			return (mW.weakAgainst & mA.elementTypes).any();
+			const auto& id(getMusicID(mID));
+			music.play(id, getAssets().assetLoader.getMusicSource(id));
 		}
 
-		inline static auto getWeaponDamageAgainst(const Weapon& mW, const Armor& mA, ATK mBonusATK, DEF mBonusDEF)
+		inline void onPrefetchMusic(MusicID mID) override
 		{
-			auto result((mW.atk + mBonusATK) - (mA.def + mBonusDEF));
-			if(isWeaponStrongAgainst(mW, mA)) result *= Constants::bonusMultiplier;
-			if(isWeaponWeakAgainst(mW, mA)) result *= Constants::malusMultiplier;
-			return ssvu::getClampedMin(result, 0);
-		}
+			GGJ_PROFILE_SCOPE(Audio);
 
-		inline static bool canWeaponDamage(const Weapon& mW, const Armor& mA, ATK mBonusATK, DEF mBonusDEF)
-		{
-			return getWeaponDamageAgainst(mW, mA, mBonusATK, mBonusDEF) > 0;
+			const auto& id(getMusicID(mID));
+			music.prefetch(id, getAssets().assetLoader.getMusicSource(id));
 		}
+
+		inline void onStopMusic() override { GGJ_PROFILE_SCOPE(Audio); music.stop(); }
+		inline void onStopSounds() override { GGJ_PROFILE_SCOPE(Audio); getAssets().voices.stop(); }
 	};
 
-	struct Creature
+	// Runs the `GameSession` on its own thread, so that a slow room generation, fight or audio call
+	// never delays a frame and a slow frame never delays the session. Input reaches the session as
+	// commands through a lock-free queue. After handling commands and after every batch of fixed
+	// steps, the thread publishes a `View` that the render thread draws from without waiting.
+	class Simulation
 	{
-		std::string name{"Unnamed"};
-		Weapon weapon;
-		Armor armor;
-		HPS hps{-1};
-
-		ATK bonusATK{0};
-		DEF bonusDEF{0};
-
-		inline void attackOnce(Creature& mX)
-		{
-			auto dmg(Calculations::getWeaponDamageAgainst(weapon, mX.armor, bonusATK, mX.bonusDEF));
-			mX.hps -= dmg;
-		}
-
-		void checkBurns(GameSession& mGameSession);
+		public:
+			struct Command
+			{
+				enum class Type : int {Choice = 0, Menu = 1};
 
-		inline void fight(Creature& mX)
-		{
-			eventLo() << name << " engages " << mX.name << "!\n";
-			auto hpsBefore(hps);
-			auto xHPSBefore(mX.hps);
+				Type type{Type::Choice};
+				int key{0};				// Choice commands only
+				std::uint64_t seq{0};	// Numbered by the sender, starting from 1
+			};
 
-			while(true)
+			struct View
 			{
-				attackOnce(mX);
-				if(mX.isDead()) break;
-
-				mX.attackOnce(*this);
-				if(isDead()) break;
-			}
+				SessionView session;
+				SizeT activeVoices{0};
+				std::uint64_t droppedVoices{0}, stolenVoices{0};
+				std::uint64_t commandsHandled{0};	// `seq` of the last command handled
+			};
 
-			if(isDead())
-				eventLo() << mX.name << " wins. HPS " << xHPSBefore << " -> " << mX.hps << "!\n";
-			else
-				eventLo() << name << " wins. HPS " << hpsBefore << " -> " << hps << "!\n";
-		}
+		private:
+			using Clock = std::chrono::steady_clock;
 
-		inline bool canDamage(Creature& mX) const noexcept
-		{
-			return Calculations::canWeaponDamage(weapon, mX.armor, bonusATK, mX.bonusDEF);
-		}
+			// Every run is recorded and saved to `lastRunPath` when it ends. A replay passed on the
+			// command line is played back instead, once the gameplay assets are resident.
+			static constexpr const char* lastRunPath{"lastRun.ggjr"};
 
-		inline bool isDead() const noexcept { return hps <= 0; }
+			AudioObserver audio;
+			GameSession gs{audio};
+			ReplayRecorder recorder;
+			RunReplay playback;
+			ReplayPlayer replayPlayer;
+			bool playbackPending{false};
 
-		inline std::string getLogStr() const
-		{
-			std::string result;
+			FT timestep;
+			Clock::duration stepDuration;
+			int maxSteps;
 
-			result += "HPS: " + ssvu::toStr(hps) + ", ";
-			result += "ATK: " + ssvu::toStr(weapon.atk) + ", ";
-			result += "DEF: " + ssvu::toStr(armor.def) + ", ";
-			result += "Str: " + ssvu::toStr(weapon.strongAgainst) + ", ";
-			result += "Wkk: " + ssvu::toStr(weapon.weakAgainst);
+			SPSCQueue<Command, 64> commands;
+			TripleBuffer<View> views;
+			std::uint64_t commandsHandled{0};
 
-			return result;
-		}
-	};
+			// Sessions start, and sounds are played, only once the render thread has published the
+			// gameplay assets. Exiting from the menu is requested back to the render thread.
+			std::atomic<bool> gameplayReady{false}, quitRequested{false}, running{true};
 
-	namespace Impl
-	{
-		struct NameGenData
-		{
-			float chance;
-			std::string str;
+			// Only used to sleep until the next step. Senders notify without locking: a command
+			// sent right as the thread goes to sleep waits for the next step at most.
+			std::mutex sleepMutex;
+			std::condition_variable sleepCV;
 
-			inline NameGenData(float mChance, const std::string& mStr) : chance{mChance}, str{mStr} { }
-		};
+			// Declared last: started once everything else is constructed
+			std::thread thread;
 
-		// TODO: ?
-		struct Gen
-		{
-			inline const auto& getWeapons()
+			inline void startRun(GameSession::Mode mMode)
 			{
-				static std::vector<NameGenData> result
-				{
-					{1.0f,		"Sword"},
-					{1.0f,		"Spear"},
-					{1.0f,		"Staff"},
-					{1.0f,		"Gauntlet"},
-					{1.0f,		"Wand"},
-					{0.8f,		"Greatsword"},
-					{0.8f,		"Claymore"},
-					{0.7f,		"Magical sword"},
-					{0.7f,		"Enchanted gauntlets"},
-					{0.5f,		"Greatstaff"},
-				};
-
-				return result;
+				recorder.begin(gs, mMode, (std::uint64_t{std::random_device{}()} << 32) ^ std::random_device{}());
 			}
 
-			inline const auto& getItemModifiers()
+			inline void updateReplays(FT mFT)
 			{
-				static std::vector<NameGenData> result
+				if(recorder.endTick(gs, mFT))
 				{
-					{1.0f,		"Rusty"},
-					{1.0f,		"Damaged"},
-					{1.0f,		"Dented"},
-					{1.0f,		"Regular"},
-					{0.8f,		"Powerful"},
-					{0.8f,		"Intense"},
-					{0.8f,		"Heavy"},
-					{0.7f,		"Incredible"},
-					{0.7f,		"Excellent"},
-					{0.5f,		"Supreme"},
-				};
+					auto saved(recorder.getReplay().writeToFile(lastRunPath));
+					ssvu::lo("Replay") << (saved ? "Run saved to " : "Cannot save run to ") << lastRunPath << "\n";
+				}
 
-				return result;
+				if(!replayPlayer.isPlaying()) return;
+
+				replayPlayer.endTick(gs);
+				if(replayPlayer.isPlaying()) return;
+
+				auto diverged(replayPlayer.getDivergedRoom());
+				if(diverged == -1) ssvu::lo("Replay") << "Playback ended in room " << gs.roomNumber << "\n";
+				else ssvu::lo("Replay") << "Playback diverged from the recording in room " << diverged << "\n";
 			}
 
-			inline const auto& getCreatures()
+			inline void executeChoice(int mI)
 			{
-				static std::vector<NameGenData> result
+				if(gs.state == GameSession::State::Menu)
 				{
-					{1.0f,		"Slime"},
-					{1.0f,		"Skeleton"},
-					{1.0f,		"Dragonkin"},
-					{1.0f,		"Giant crab"},
-					{0.8f,		"Undead"},
-					{0.8f,		"Zombie"},
-					{0.8f,		"Dragon"},
-					{0.7f,		"Ghost"},
-					{0.7f,		"Bloodkin"},
-					{0.5f,		"Scolarship"},
-				};
+					if(mI == 3) quitRequested.store(true, std::memory_order_relaxed);
 
-				return result;
-			}
+					// Sessions can only start once the gameplay assets are resident
+					if(mI >= 3 || !gameplayReady.load(std::memory_order_acquire)) return;
 
-			inline const auto& getCreatureModifier()
-			{
-				static std::vector<NameGenData> result
+					if(mI == 0) startRun(GameSession::Mode::Beginner);
+					if(mI == 1) startRun(GameSession::Mode::Official);
+					if(mI == 2) startRun(GameSession::Mode::Hardcore);
+
+					return;
+				}
+
+				if(gs.state == GameSession::State::Dead)
 				{
-					{1.0f,		"Injured"},
-					{1.0f,		"Diseased"},
-					{1.0f,		"Enraged"},
-					{1.0f,		"Powerful"},
-					{0.8f,		"Undead"},
-					{0.8f,		"Magical"},
-					{0.8f,		"Enchanted"},
-					{0.7f,		"Phantasm"},
-					{0.7f,		"Bloodthirsty"},
-					{0.5f,		"Ravaging"},
-				};
+					if(mI == 0) gs.gotoMenu();
+					else if(mI == 1) startRun(gs.mode);
 
-				return result;
+					return;
+				}
+
+				// Choices of a replay being played back come from the recording only
+				if(replayPlayer.isPlaying()) return;
+
+				recorder.execute(gs, mI);
 			}
 
-			template<typename T> inline const auto& getR(const T& mX)
+			inline bool handleCommands()
 			{
-				float weightSum{0.f};
-				for(const auto& x : mX) weightSum += x.chance;
-				auto r(ssvu::getRndR(0.f, weightSum));
-				auto t(0.f);
+				Command c;
+				auto handled(false);
 
-				for(const auto& x : mX)
+				while(commands.tryPop(c))
 				{
-					t += x.chance;
-					if(t > r) return x.str;
+					if(c.type == Command::Type::Choice) executeChoice(c.key);
+					else if(gs.state != GameSession::State::Menu) gs.gotoMenu();
+
+					commandsHandled = c.seq;
+					handled = true;
 				}
 
-				return mX[ssvu::getRnd(0ul, mX.size())].str;
+				return handled;
 			}
 
-			template<typename T> inline void whileChance(int mChance, const T& mFn)
+			inline void step(FT mFT)
 			{
-				while(ssvu::getRnd(0, 100) < mChance)
+				if(playbackPending && gameplayReady.load(std::memory_order_acquire))
 				{
-					mFn();
-					mChance /= 2;
-					if(mChance < 2) mChance = 2;
+					playbackPending = false;
+					replayPlayer.begin(gs, playback);
 				}
+
+				if(gs.deathTextTime > 0) gs.deathTextTime -= mFT;
+
+				replayPlayer.applyPresses(gs);
+				gs.updateTimer(mFT);
+				updateReplays(mFT);
+
+				if(gs.state == GameSession::State::Playing)
+				{
+					auto secs(ssvu::getFTToSeconds(gs.timer));
+					if(secs < 3) ssvu::clampMin(gs.shake, 4 - secs);
+				}
+
+				if(gs.shake > 0) gs.shake -= mFT;
 			}
 
-			inline auto generateWeaponName()
+			inline void publish()
 			{
-				std::string result;
-				return result;
+				auto& v(views.getBack());
+				const auto& vp(getAssets().voices);
+
+				v.session.capture(gs);
+				v.activeVoices = vp.getActiveCount();
+				v.droppedVoices = vp.getDroppedCount();
+				v.stolenVoices = vp.getStolenCount();
+				v.commandsHandled = commandsHandled;
+
+				views.publish();
 			}
 
-			inline auto generateCreatureName()
+			inline void run()
 			{
-				std::string result;
+				auto next(Clock::now());
 
-				whileChance(25, [this, &result]{ result += getR(getCreatureModifier()) + " "; });
-				result += getR(getCreatures());
+				while(running.load(std::memory_order_relaxed))
+				{
+					// Commands are handled as soon as they arrive, between steps
+					if(handleCommands()) publish();
 
-				return result;
-			}
-		};
-	}
+					auto now(Clock::now());
+					auto steps(0);
 
-	inline auto& getGen() noexcept { static Impl::Gen result; return result; }
+					for(; next <= now && steps < maxSteps; ++steps)
+					{
+						step(timestep);
+						next += stepDuration;
+					}
 
-	struct InstantEffect
-	{
-		enum class Type : int
-		{
-			Add = 0,
-			Sub = 1,
-			Mul = 2,
-			Div = 3
-		};
+					// After a stall, the rest of the backlog is dropped
+					if(next <= now) next = now + stepDuration;
+					if(steps > 0) publish();
 
-		enum class Stat : int
-		{
-			SHPS = 0,
-			SATK = 1,
-			SDEF = 2
-		};
+					std::unique_lock<std::mutex> lock{sleepMutex};
+					sleepCV.wait_until(lock, next, [this]{ return !running.load(std::memory_order_relaxed) || !commands.isEmpty(); });
+				}
+			}
 
-		Type type;
-		Stat stat;
-		float value;
+		public:
+			inline Simulation(const Boilerplate::LoopConfig& mLoop, const std::string& mReplayPath)
+				: timestep{mLoop.timestep},
+				stepDuration{std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(ssvu::getFTToSeconds(mLoop.timestep)))},
+				maxSteps{static_cast<int>(mLoop.maxCatchUp)}
+			{
+				// Picking a choice should only swap in a room generated while the player was deciding
+				gs.pregenerate = true;
+				gs.gotoMenu();
 
-		inline InstantEffect(Type mType, Stat mStat, float mValue) : type{mType}, stat{mStat}, value{mValue} { }
-		inline void apply(GameSession& mGameSession, Creature& mX);
+				if(!mReplayPath.empty())
+				{
+					playbackPending = playback.readFromFile(mReplayPath);
+					if(!playbackPending) ssvu::lo("Replay") << "Cannot read replay " << mReplayPath << "\n";
+				}
 
-		inline std::string getStrType()
-		{
-			static auto array(ssvu::makeArray
-			(
-				"+",
-				"-",
-				"*",
-				"/"
-			));
+				publish();
+				thread = std::thread{[this]{ run(); }};
+			}
 
-			return array[static_cast<int>(type)];
-		}
+			inline ~Simulation()
+			{
+				{
+					std::lock_guard<std::mutex> lock{sleepMutex};
+					running.store(false, std::memory_order_relaxed);
+				}
 
-		inline std::string getStrStat()
-		{
-			static auto array(ssvu::makeArray
-			(
-				"HPS",
-				"ATK",
-				"DEF"
-			));
+				sleepCV.notify_one();
+				thread.join();
+			}
 
-			return array[static_cast<int>(stat)];
-		}
-	};
+			inline Simulation(const Simulation&) = delete;
+			inline Simulation& operator=(const Simulation&) = delete;
 
-	struct Drop
-	{
-		GameSession& gameSession;
-		sf::Sprite card;
+			/// @brief Render thread only. Returns false if the queue is full and the command was dropped.
+			inline bool send(const Command& mX)
+			{
+				if(!commands.tryPush(mX)) return false;
 
-		inline Drop(GameSession& mGameSession) : gameSession{mGameSession}
-		{
-			card.setTexture(*getAssets().itemCard);
-			ssvs::setOrigin(card, ssvs::getLocalCenter);
-		}
+				sleepCV.notify_one();
+				return true;
+			}
 
-		inline virtual ~Drop() { }
-		inline virtual void apply(Creature&) { }
+			/// @brief Render thread only. Call once the gameplay assets are resident and published.
+			inline void setGameplayReady() noexcept { gameplayReady.store(true, std::memory_order_release); }
 
-		inline virtual void draw(ssvs::GameWindow& mGW, const Vec2f&, const Vec2f& mCenter)
-		{
-			card.setPosition(mCenter + Vec2f{0, -20.f});
-			mGW.draw(card);
-		}
+			inline bool isQuitRequested() const noexcept { return quitRequested.load(std::memory_order_relaxed); }
+
+			/// @brief Render thread only. Takes the latest published view, returning true if there was a new one.
+			inline bool updateView() noexcept { return views.update(); }
+
+			/// @brief Render thread only. Valid until the next `updateView`.
+			inline const View& getView() const noexcept { return views.getFront(); }
 	};
 
+	constexpr const char* Simulation::lastRunPath;
 
 	inline auto createElemSprite(int mEI)
 	{
@@ -516,7 +527,7 @@ namespace ggj
 
 			s.setPosition(mX.getPosition() + Vec2f{12.f + offset, 0.f});
 
-			mGW.draw(s);
+			Boilerplate::draw(mGW, s);
 		}
 	}
 
@@ -525,6 +536,13 @@ namespace ggj
 		return ssvu::toStr(mBase + mBonus) + " (" + ssvu::toStr(mBase) + "+" + ssvu::toStr(mBonus) + ")";
 	}
 
+	inline std::string getMsStr(float mMs)
+	{
+		char result[16];
+		std::snprintf(result, sizeof(result), "%.1fms", mMs);
+		return result;
+	}
+
 	struct StatRichText
 	{
 		ssvs::BitmapTextRich txt{*getAssets().fontObStroked};
@@ -555,8 +573,25 @@ namespace ggj
 			(*pssExtra) << sf::Color::White << ")";
 		}
 
+		// Last values shown: the text is only rebuilt when they change
+		bool shown{false}, shownExtra{false};
+		StatType shownBase{0}, shownBonus{0};
+
+		inline bool mustRefresh(bool mExtra, StatType mBase, StatType mBonus)
+		{
+			if(shown && shownExtra == mExtra && shownBase == mBase && shownBonus == mBonus) return false;
+
+			shown = true;
+			shownExtra = mExtra;
+			shownBase = mBase;
+			shownBonus = mBonus;
+			return true;
+		}
+
 		inline void set(StatType mX)
 		{
+			if(!mustRefresh(false, mX, 0)) return;
+
 			pssExtra->setEnabled(false);
 
 			auto s(ssvu::toStr(mX));
@@ -565,6 +600,8 @@ namespace ggj
 
 		inline void set(StatType mBase, StatType mBonus)
 		{
+			if(!mustRefresh(true, mBase, mBonus)) return;
+
 			pssExtra->setEnabled(true);
 
 			auto sBase(ssvu::toStr(mBase));
@@ -591,7 +628,7 @@ namespace ggj
 			eWK.setTexture(*getAssets().eWK);
 		}
 
-		inline void commonDraw(Weapon& mW, ssvs::GameWindow& mGW, const Vec2f& mPos, const Vec2f&)
+		inline void commonDraw(const Weapon& mW, ssvs::GameWindow& mGW, const Vec2f& mPos, const Vec2f&)
 		{
 			iconATK.setPosition(mPos + pos);
 			eST.setPosition(iconATK.getPosition() + Vec2f{0, 10 + 1});
@@ -601,19 +638,19 @@ namespace ggj
 			appendElems(mGW, eST, mW.strongAgainst);
 			appendElems(mGW, eWK, mW.weakAgainst);
 
-			mGW.draw(iconATK);
-			mGW.draw(srtATK.txt);
-			mGW.draw(eST);
-			mGW.draw(eWK);
+			Boilerplate::draw(mGW, iconATK);
+			Boilerplate::draw(mGW, srtATK.txt);
+			Boilerplate::draw(mGW, eST);
+			Boilerplate::draw(mGW, eWK);
 		}
 
-		inline void draw(Weapon& mW, ssvs::GameWindow& mGW, const Vec2f& mPos, const Vec2f& mCenter)
+		inline void draw(const Weapon& mW, ssvs::GameWindow& mGW, const Vec2f& mPos, const Vec2f& mCenter)
 		{
 			srtATK.set(mW.atk);
 			commonDraw(mW, mGW, mPos, mCenter);
 		}
 
-		inline void draw(Creature& mC, ssvs::GameWindow& mGW, const Vec2f& mPos, const Vec2f& mCenter)
+		inline void draw(const Creature& mC, ssvs::GameWindow& mGW, const Vec2f& mPos, const Vec2f& mCenter)
 		{
 			srtATK.set(mC.weapon.atk, mC.bonusATK);
 			commonDraw(mC.weapon, mGW, mPos, mCenter);
@@ -633,25 +670,25 @@ namespace ggj
 			eTY.setTexture(*getAssets().eTY);
 		}
 
-		inline void commonDraw(Armor& mA, ssvs::GameWindow& mGW, const Vec2f& mPos, const Vec2f&)
+		inline void commonDraw(const Armor& mA, ssvs::GameWindow& mGW, const Vec2f& mPos, const Vec2f&)
 		{
 			iconDEF.setPosition(pos + mPos);
 			eTY.setPosition(iconDEF.getPosition() + Vec2f{0, 10 + 1});
 			srtDEF.txt.setPosition(iconDEF.getPosition() + Vec2f{12.f, 0});
-			mGW.draw(iconDEF);
-			mGW.draw(srtDEF.txt);
-			mGW.draw(eTY);
+			Boilerplate::draw(mGW, iconDEF);
+			Boilerplate::draw(mGW, srtDEF.txt);
+			Boilerplate::draw(mGW, eTY);
 
 			appendElems(mGW, eTY, mA.elementTypes);
 		}
 
-		inline void draw(Armor& mA, ssvs::GameWindow& mGW, const Vec2f& mPos, const Vec2f& mCenter)
+		inline void draw(const Armor& mA, ssvs::GameWindow& mGW, const Vec2f& mPos, const Vec2f& mCenter)
 		{
 			srtDEF.set(mA.def);
 			commonDraw(mA, mGW, mPos, mCenter);
 		}
 
-		inline void draw(Creature& mC, ssvs::GameWindow& mGW, const Vec2f& mPos, const Vec2f& mCenter)
+		inline void draw(const Creature& mC, ssvs::GameWindow& mGW, const Vec2f& mPos, const Vec2f& mCenter)
 		{
 			srtDEF.set(mC.armor.def, mC.bonusDEF);
 			commonDraw(mC.armor, mGW, mPos, mCenter);
@@ -662,6 +699,8 @@ namespace ggj
 	{
 		sf::Sprite iconHPS;
 		ssvs::BitmapText txtHPS;
+		HPS shownHPS{0};
+		bool shown{false};
 
 		WeaponStatsDraw wsd;
 		ArmorStatsDraw asd;
@@ -671,9 +710,15 @@ namespace ggj
 			iconHPS.setTexture(*getAssets().iconHPS);
 		}
 
-		inline void draw(Creature& mC, ssvs::GameWindow& mGW, const Vec2f& mPos, const Vec2f& mCenter)
+		inline void draw(const Creature& mC, ssvs::GameWindow& mGW, const Vec2f& mPos, const Vec2f& mCenter)
 		{
-			txtHPS.setString(ssvu::toStr(mC.hps));
+			if(!shown || shownHPS != mC.hps)
+			{
+				shown = true;
+				shownHPS = mC.hps;
+				txtHPS.setString(ssvu::toStr(mC.hps));
+			}
+
 			iconHPS.setPosition(mPos + Vec2f{0.f, 12.f * 0.f});
 			txtHPS.setPosition(iconHPS.getPosition() + Vec2f{12.f, 0});
 
@@ -683,785 +728,328 @@ namespace ggj
 			asd.pos = Vec2f{0, wsd.eWK.getPosition().y - mPos.y + 12.f};
 			asd.draw(mC, mGW, mPos, mCenter);
 
-			mGW.draw(iconHPS);
-			mGW.draw(txtHPS);
+			Boilerplate::draw(mGW, iconHPS);
+			Boilerplate::draw(mGW, txtHPS);
 		}
 	};
 
-	struct WeaponDrop : public Drop
+
+	struct DropDraw
 	{
-		Weapon weapon;
+		sf::Sprite itemCard, equipCard;
+		sf::Sprite typeSprite, armorSprite;
 		WeaponStatsDraw wsd;
-		sf::Sprite typeSprite;
+		ArmorStatsDraw asd;
+		std::vector<ssvs::BitmapText> bts;
+		std::vector<InstantEffect> shownIEs;
 
-		inline WeaponDrop(GameSession& mGameSession) : Drop{mGameSession}
+		inline DropDraw()
 		{
-			card.setTexture(*getAssets().equipCard);
-		}
+			itemCard.setTexture(*getAssets().itemCard);
+			ssvs::setOrigin(itemCard, ssvs::getLocalCenter);
 
-		inline void apply(Creature& mX) override
-		{
-			getAssets().soundPlayer.play(*getAssets().equipWpn);
-			mX.weapon = weapon;
+			equipCard.setTexture(*getAssets().equipCard);
+			ssvs::setOrigin(equipCard, ssvs::getLocalCenter);
+
+			armorSprite.setTexture(*getAssets().armDrop);
+			ssvs::setOrigin(armorSprite, ssvs::getLocalCenter);
 		}
 
-		inline void draw(ssvs::GameWindow& mGW, const Vec2f& mPos, const Vec2f& mCenter) override
+		inline void drawWeapon(const Weapon& mW, ssvs::GameWindow& mGW, const Vec2f& mPos, const Vec2f& mCenter)
 		{
-			Drop::draw(mGW, mPos, mCenter);
-
-			typeSprite.setTexture(weapon.getTypeTexture());
+			typeSprite.setTexture(getWeaponTypeTexture(mW));
 			ssvs::setOrigin(typeSprite, ssvs::getLocalCenter);
-			typeSprite.setPosition(card.getPosition());
-			mGW.draw(typeSprite);
+			typeSprite.setPosition(equipCard.getPosition());
+			Boilerplate::draw(mGW, typeSprite);
 
 			wsd.pos = Vec2f{30 - 16, 30 + 6};
-			wsd.draw(weapon, mGW, mPos, mCenter);
+			wsd.draw(mW, mGW, mPos, mCenter);
 		}
-	};
 
-	struct ArmorDrop : public Drop
-	{
-		Armor armor;
-		ArmorStatsDraw asd;
-		sf::Sprite armorSprite;
-
-		inline ArmorDrop(GameSession& mGameSession) : Drop{mGameSession}
+		inline void drawArmor(const Armor& mA, ssvs::GameWindow& mGW, const Vec2f& mPos, const Vec2f& mCenter)
 		{
-			card.setTexture(*getAssets().equipCard);
+			armorSprite.setPosition(equipCard.getPosition());
+			Boilerplate::draw(mGW, armorSprite);
+
+			asd.pos = Vec2f{30 - 16, 30 + 6};
+			asd.draw(mA, mGW, mPos, mCenter);
 		}
 
-		inline void apply(Creature& mX) override
+		inline void drawIE(const DropView& mD, ssvs::GameWindow& mGW)
 		{
-			getAssets().soundPlayer.play(*getAssets().equipArmor);
-			mX.armor = armor;
+			bts.resize(mD.ieCount, mkTxtOBSmall());
+			shownIEs.resize(mD.ieCount);
+
+			for(auto i(0u); i < mD.ieCount; ++i)
+			{
+				auto& ie(mD.ies[i]);
+				auto& t(bts[i]);
+				auto& shown(shownIEs[i]);
+
+				if(shown.type != ie.type || shown.stat != ie.stat || shown.value != ie.value)
+				{
+					shown = ie;
+					t.setString(ie.getStrType() + ssvu::toStr(static_cast<int>(ie.value)) + " " + ie.getStrStat());
+					ssvs::setOrigin(t, ssvs::getLocalCenter);
+				}
+
+				t.setPosition(itemCard.getPosition() + Vec2f{0, -15.f + (10 * i)});
+				Boilerplate::draw(mGW, t);
+			}
 		}
 
-		inline void draw(ssvs::GameWindow& mGW, const Vec2f& mPos, const Vec2f& mCenter) override
+		inline void draw(const DropView& mD, ssvs::GameWindow& mGW, const Vec2f& mPos, const Vec2f& mCenter)
 		{
-			Drop::draw(mGW, mPos, mCenter);
-
-			armorSprite.setTexture(*getAssets().armDrop);
-			ssvs::setOrigin(armorSprite, ssvs::getLocalCenter);
-			armorSprite.setPosition(card.getPosition());
-			mGW.draw(armorSprite);
+			auto& card(mD.type == Drop::Type::IE ? itemCard : equipCard);
+			card.setPosition(mCenter + Vec2f{0, -20.f});
+			Boilerplate::draw(mGW, card);
 
-			asd.pos = Vec2f{30 - 16, 30 + 6};
-			asd.draw(armor, mGW, mPos, mCenter);
+			switch(mD.type)
+			{
+				case Drop::Type::Weapon: drawWeapon(mD.weapon, mGW, mPos, mCenter); break;
+				case Drop::Type::Armor: drawArmor(mD.armor, mGW, mPos, mCenter); break;
+				case Drop::Type::IE: drawIE(mD, mGW); break;
+			}
 		}
 	};
 
-	struct DropIE : public Drop
+	struct SlotChoice
 	{
-		std::vector<InstantEffect> ies;
-		std::vector<ssvs::BitmapText> bts;
+		sf::RectangleShape shape;
+		sf::Sprite sprite;
+		int choice;
 
-		inline DropIE(GameSession& mGameSession) : Drop{mGameSession} { }
+		// Per-slot views of the choice currently in this slot
+		sf::Sprite advanceSprite, enemySprite, dropsSprite;
+		CreatureStatsDraw csd;
+		DropDraw dropDraw;
+		const void* lastChoice{nullptr};
+		float hoverRads{0.f};
 
-		inline void addIE(InstantEffect mIE)
-		{
-			ies.emplace_back(mIE);
+		static constexpr float step{300.f / 4.f};
 
-			ssvs::BitmapText txt{mkTxtOBSmall()};
-			txt.setString(mIE.getStrType() + ssvu::toStr(static_cast<int>(mIE.value)) + " " + mIE.getStrStat());
-			ssvs::setOrigin(txt, ssvs::getLocalCenter);
+		inline SlotChoice(int mChoice) : choice{mChoice}
+		{
+			shape.setSize(Vec2f{step, 130.f});
+			shape.setFillColor(sf::Color::Red);
+			shape.setPosition(Vec2f{10 + step * mChoice, 40});
 
-			bts.emplace_back(txt);
-		}
+			sprite.setTexture(*getAssets().slotChoice);
+			sprite.setPosition(Vec2f{10 + step * mChoice, 40});
 
-		inline void apply(Creature& mX) override
-		{
-			getAssets().soundPlayer.play(*getAssets().powerup, ssvs::SoundPlayer::Mode::Overlap, 1.8f);
-			for(auto& x : ies) x.apply(gameSession, mX);
-		}
 
-		inline void draw(ssvs::GameWindow& mGW, const Vec2f& mPos, const Vec2f& mCenter) override
-		{
-			Drop::draw(mGW, mPos, mCenter);
+			advanceSprite.setTexture(*getAssets().advance);
+			ssvs::setOrigin(advanceSprite, ssvs::getLocalCenter);
 
-			int i{0};
-			for(auto& t : bts)
-			{
-				t.setPosition(card.getPosition() + Vec2f{0, -15.f + (10 * i)});
-				mGW.draw(t);
+			enemySprite.setTexture(*getAssets().enemy);
+			ssvs::setOrigin(enemySprite, ssvs::getLocalCenter);
 
-				++i;
-			}
+			dropsSprite.setTexture(*getAssets().drops);
 		}
-	};
-
 
+		template<typename TTarget> inline void drawLabels(TTarget& mTarget, const std::string& mStr)
+		{
+			static const std::string nums[]{"1", "2", "3", "4"};
 
-	struct ItemDrops
-	{
-		ssvu::UPtr<Drop> drops[Constants::maxDrops];
+			getBigLabels().draw(mTarget, nums[choice], Vec2f{10 + step * choice + (step / 2.f), 40 + 105});
+			getSmallLabels().draw(mTarget, mStr, Vec2f{10 + step * choice + (step / 2.f), 40 + 120});
+		}
 
-		inline ItemDrops()
+		inline Vec2f getCenter()
 		{
-			for(auto i(0u); i < Constants::maxDrops; ++i)
-				drops[i] = nullptr;
+			return Vec2f{10 + (step * choice) + (step / 2.f), 40 + 130.f / 2.f};
 		}
 
-		inline bool has(int mIdx)
+		template<typename TTarget> inline void drawInCenter(TTarget& mTarget, const sf::Texture& mX)
 		{
-			return drops[mIdx] != nullptr;
+			sf::Sprite s;
+			s.setTexture(mX);
+			ssvs::setOrigin(s, ssvs::getLocalCenter);
+			s.setPosition(getCenter());
+			Boilerplate::draw(mTarget, s);
 		}
 
-		inline void give(int mIdx, Creature& mX)
+		inline void drawChoice(const ChoiceView& mC, ssvs::GameWindow& mGW, Rng& mCosmeticRng)
 		{
-			drops[mIdx]->apply(mX);
-			drops[mIdx].release();
-		}
-	};
+			if(lastChoice != mC.id)
+			{
+				lastChoice = mC.id;
+				hoverRads = mCosmeticRng.getRndR(0.f, ssvu::tau);
+			}
 
-	class GameSession;
+			const auto& pos(shape.getPosition());
+			auto center(getCenter());
 
-	struct Choice
-	{
-		GameSession& gameSession;
-		SizeT idx;
+			switch(mC.type)
+			{
+				case Choice::Type::Advance:
+					advanceSprite.setPosition(center);
+					Boilerplate::draw(mGW, advanceSprite);
+					break;
 
-		inline Choice(GameSession& mGameState, SizeT mIdx) : gameSession{mGameState}, idx{mIdx} { }
-		inline virtual ~Choice() { }
+				case Choice::Type::Creature:
+				{
+					Vec2f offset{4.f, 4.f};
+					hoverRads = ssvu::wrapRad(hoverRads + 0.05f);
+					enemySprite.setPosition(center + Vec2f(0, std::sin(hoverRads) * 4.f));
+					Boilerplate::draw(mGW, enemySprite);
+					csd.draw(mC.creature, mGW, offset + pos, center);
+					break;
+				}
 
-		inline virtual void execute() { }
-		inline virtual void draw(ssvs::GameWindow&, const Vec2f&, const Vec2f&) { }
+				case Choice::Type::ItemDrop:
+					dropsSprite.setPosition(pos);
+					Boilerplate::draw(mGW, dropsSprite);
+					break;
 
-		inline virtual std::string getChoiceStr() { return ""; }
-	};
-
-	struct ChoiceAdvance : public Choice
-	{
-		sf::Sprite advanceSprite;
-
-		inline ChoiceAdvance(GameSession& mGameState, SizeT mIdx) : Choice{mGameState, mIdx}
-		{
-			advanceSprite.setTexture(*getAssets().advance);
-			ssvs::setOrigin(advanceSprite, ssvs::getLocalCenter);
-		}
-
-		inline void execute() override;
-		inline void draw(ssvs::GameWindow&, const Vec2f&, const Vec2f&) override;
-
-		inline std::string getChoiceStr() override { return "Forward"; }
-	};
-
-
-	struct ChoiceCreature : public Choice
-	{
-		Creature creature;
-		CreatureStatsDraw csd;
-		sf::Sprite enemySprite;
-		float hoverRads;
-
-		inline ChoiceCreature(GameSession& mGameState, SizeT mIdx)
-			: Choice{mGameState, mIdx}
-		{
-			enemySprite.setTexture(*getAssets().enemy);
-			ssvs::setOrigin(enemySprite, ssvs::getLocalCenter);
-			hoverRads = ssvu::getRndR(0.f, ssvu::tau);
+				case Choice::Type::SingleDrop:
+					if(mC.hasDrop) dropDraw.draw(mC.drop, mGW, pos, center);
+					break;
+			}
 		}
-
-		inline void execute() override;
-		inline void draw(ssvs::GameWindow&, const Vec2f&, const Vec2f&) override;
-
-		inline std::string getChoiceStr() override { return "Fight"; }
-	};
-
-	struct ChoiceItemDrop : public Choice
-	{
-		sf::Sprite drops;
-		ItemDrops itemDrops;
-
-		ChoiceItemDrop(GameSession& mGS, SizeT mIdx);
-
-		inline void execute() override;
-		inline void draw(ssvs::GameWindow&, const Vec2f&, const Vec2f&) override;
-
-		inline std::string getChoiceStr() override { return "Collect"; }
 	};
 
-	struct ChoiceSingleDrop : public Choice
+#if defined(GGJ2015_PROFILER)
+	// Min/avg/p99 of every profiled phase and a graph of the recent frame times, against a 60 FPS budget
+	class ProfilerOverlay
 	{
-		ssvu::UPtr<Drop> drop{nullptr};
-
-		ChoiceSingleDrop(GameSession& mGS, SizeT mIdx);
-
-		inline void execute() override;
-		inline void draw(ssvs::GameWindow&, const Vec2f&, const Vec2f&) override;
-
-		inline std::string getChoiceStr() override { return "Pickup"; }
-	};
-
-	struct GameSession
-	{
-		enum class State : int{Playing = 0, Dead = 1, Menu = 2};
-		enum class Mode : int{Beginner = 0, Official = 1, Hardcore = 2};
-
-		State state{State::Menu};
-		int roomNumber{0};
-		Creature player;
-		ssvu::UPtr<Choice> choices[Constants::maxChoices];
-		ssvu::UPtr<Choice> nextChoices[Constants::maxChoices];
-		float timer;
-		float difficulty{1.f};
-		float rndMultiplier{1.2f};
-
-		sf::SoundBuffer* currentMusic{nullptr};
-		sf::Sound music;
-
-		ItemDrops* currentDrops{nullptr};
-
-		float shake{0}, deathTextTime{0};
-		float difficultyInc{0.03f};
-
-		Mode mode{Mode::Official};
-		bool timerEnabled{true};
-
-		inline void sustain()
-		{
-			if(player.isDead()) return;
-
-			float x(1.f + (roomNumber * 1.5f / difficulty));
-			ssvu::clampMax(x, 20);
-
-			eventLo() << "You drain " << static_cast<int>(x) << " HPS defeating the enemy\n";
-			player.hps += x;
-		}
-
-		inline void restart()
-		{
-			music.stop();
-			getAssets().soundPlayer.stop();
-
-			if(mode == Mode::Official || mode == Mode::Beginner) { difficulty = 1.f; difficultyInc = 0.038f; }
-			if(mode == Mode::Hardcore) { difficulty = 1.f; difficultyInc = 0.087f; }
-
-			timerEnabled = (mode != Mode::Beginner);
-
-			state = State::Playing;
-			roomNumber = 0;
-			shake = deathTextTime = 0.f;
-			for(auto& c : choices) c.release();
-			for(auto& c : nextChoices) c.release();
-
-			Weapon startingWeapon;
-			startingWeapon.atk = 5;
-			startingWeapon.name = "Starting weapon";
-			player.bonusATK = 1;
-
-			Armor startingArmor;
-			startingArmor.def = 2;
-			startingArmor.name = "Starting armor";
-			player.bonusDEF = 1;
-
-			player.name = "Player";
-			player.hps = 150;
-			player.weapon = startingWeapon;
-			player.armor = startingArmor;
-
-			advance();
-		}
-
-		inline void gotoMenu()
-		{
-			music.stop();
-			getAssets().soundPlayer.stop();
-			shake = deathTextTime = 0.f;
-
-			state = State::Menu;
-
-			currentMusic = getAssets().menu;
-			refreshMusic();
-		}
-
-		inline GameSession()
-		{
-			gotoMenu();
-		}
-
-		inline void tryPickupDrop(int mIdx)
-		{
-			if(!currentDrops->has(mIdx)) return;
-
-			currentDrops->give(mIdx, player);
-		}
-
-		inline void startDrops(ItemDrops* mID)
-		{
-			currentDrops = mID;
-		}
-		inline void endDrops()
-		{
-			currentDrops = nullptr;
-		}
+		private:
+			static constexpr float graphHeight{40.f};
+			static constexpr float budgetMs{1000.f / 60.f};
 
+			ssvs::BitmapText txt{mkTxtOBSmall()};
+			sf::VertexArray graph{sf::Quads};
 
-		inline void refreshChoices()
-		{
-			for(auto i(0u); i < Constants::maxChoices; ++i)
+			inline void addBar(float mX, float mY, float mW, float mH, const sf::Color& mColor)
 			{
-				if(nextChoices[i] == nullptr) continue;
-				choices[i] = std::move(nextChoices[i]);
-				nextChoices[i] = nullptr;
+				graph.append({{mX, mY}, mColor});
+				graph.append({{mX + mW, mY}, mColor});
+				graph.append({{mX + mW, mY + mH}, mColor});
+				graph.append({{mX, mY + mH}, mColor});
 			}
-		}
-
-		inline void resetTimer()
-		{
-			if(mode == Mode::Official || mode == Mode::Beginner) timer = ssvu::getSecondsToFT(10);
-			else if(mode == Mode::Hardcore) timer = ssvu::getSecondsToFT(6);
-		}
-
-		inline void generateRndElements(int mL, ElementBitset& mX)
-		{
-			auto d(static_cast<int>(mL * difficulty));
-
-			if(roomNumber < 10) return;
-
-			auto i(0u);
-			auto indices(mkShuffledVector<int>(0, 1, 2, 3));
-
-			if(ssvu::getRnd(0, 100) < 50) mX[indices[i++]] = true;
-
-			if(d < 20) return;
-			if(ssvu::getRnd(0, 100) < 45) mX[indices[i++]] = true;
-
-			if(d < 30) return;
-			if(ssvu::getRnd(0, 100) < 40) mX[indices[i++]] = true;
-
-			if(d < 40) return;
-			if(ssvu::getRnd(0, 100) < 35) mX[indices[i++]] = true;
-		}
-
-		inline int getRndStat(int mL, float, float)
-		{
-			auto d(static_cast<int>(((mL * 0.8f) + 4) * difficulty));
-
-			return ssvu::getClampedMin(ssvu::getRnd((int)(d * 0.65f), (int)(d * 1.55f)), 0);
-//			return ssvu::getClampedMin(1, d + ssvu::getRnd(static_cast<int>((mMultMin * d) * rndMultiplier), static_cast<int>((mMultMax * d) * rndMultiplier)));
-		}
-
-		inline InstantEffect generateInstantEffect(InstantEffect::Stat mStat, InstantEffect::Type mType, int mL)
-		{
-			float val(ssvu::getClampedMin((mL / 8) + ssvu::getRnd(0, 3 + (mL / 12)), 1));
-			if(mStat == InstantEffect::Stat::SHPS) val = mL * (10 + ssvu::getRnd(-2, 3));
-
-			return {mType, mStat, val};
-		}
-
-		inline auto getShuffledStats()
-		{
-			return mkShuffledVector<InstantEffect::Stat>
-			(
-				InstantEffect::Stat::SHPS,
-				InstantEffect::Stat::SATK,
-				InstantEffect::Stat::SDEF
-			);
-		}
-
-		inline auto addIEs(int mL, DropIE& dIE)
-		{
-			auto ss(getShuffledStats());
-
-			dIE.addIE(generateInstantEffect(ss[0], InstantEffect::Type::Add, mL));
-			dIE.addIE(generateInstantEffect(ss[1], InstantEffect::Type::Sub, mL));
-		}
-
 
-		inline auto generateDropIE(int mL)
-		{
-			auto dIE(ssvu::makeUPtr<DropIE>(*this));
-
-			addIEs(mL, *dIE);
+		public:
+			inline ProfilerOverlay() { txt.setPosition(Vec2f{4, 4}); }
 
-			if(ssvu::getRnd(0, 100) < ssvu::getClampedMax(mL, 35))
+			template<typename TTarget> inline void draw(TTarget& mTarget)
 			{
-				addIEs(mL, *dIE);
-			}
-
-			// if(ssvu::getRnd(0, 100) < 25) dIE->addIE(generateInstantEffect(mL));
-
-			return dIE;
-		}
-
-		inline auto generateDropWeapon(int mL)
-		{
-			auto dr(ssvu::makeUPtr<WeaponDrop>(*this));
-			dr->weapon = generateWeapon(mL);
-
-			return dr;
-		}
+				const auto& profiler(Profiler::getProfiler());
 
-		inline auto generateDropArmor(int mL)
-		{
-			auto dr(ssvu::makeUPtr<ArmorDrop>(*this));
-			dr->armor = generateArmor(mL);
+				std::string str{"Phase (ms)       min   avg   p99\n"};
+				char line[64];
 
-			return dr;
-		}
+				for(auto i(0u); i < Profiler::phaseCount; ++i)
+				{
+					auto phase(static_cast<Profiler::Phase>(i));
+					auto stats(profiler.getStats(phase));
 
-		inline ssvu::UPtr<Drop> generateRndDrop(int mL)
-		{
-			if(ssvu::getRnd(0, 50) > 21)
-			{
-				return std::move(generateDropIE(mL));
-			}
-			else
-			{
-				if(ssvu::getRnd(0, 50) > 19)
-					return std::move(generateDropWeapon(mL));
-				else
-					return std::move(generateDropArmor(mL));
-			}
-		}
+					std::snprintf(line, sizeof(line), "%-15s %5.2f %5.2f %5.2f\n", Profiler::getPhaseStr(phase), stats.min, stats.avg, stats.p99);
+					str += line;
+				}
 
-		inline ItemDrops generateDrops(int mL)
-		{
-//			auto d(static_cast<int>(mL * difficultyMultiplier));
+				txt.setString(str);
 
-			ItemDrops result;
+				// One bar per frame; the scale tops out at twice the budget, marked by the white line
+				const float left{40.f}, bottom{236.f};
+				auto x(left);
 
-			auto i(0u);
-			result.drops[i] = std::move(generateRndDrop(mL));
+				graph.clear();
+				addBar(left, bottom - graphHeight / 2.f, Profiler::frameCount, 1.f, sf::Color::White);
 
-			for(; i < Constants::maxDrops; ++i)
-			{
-				if(ssvu::getRnd(0, 50) > 20) continue;
+				profiler.forFrames(Profiler::Phase::Frame, [this, &x, bottom](float mMs)
+				{
+					auto h(ssvu::getClampedMax(mMs / (budgetMs * 2.f), 1.f) * graphHeight);
+					addBar(x++, bottom - h, 1.f, h, mMs <= budgetMs ? sf::Color::Green : sf::Color::Red);
+				});
 
-				result.drops[i] = std::move(generateRndDrop(mL));
+				mTarget.draw(graph);
+				mTarget.draw(txt);
 			}
+	};
+#endif
 
-			return result;
-		}
-
-		inline Weapon generateWeapon(int mL)
-		{
-			auto d(static_cast<int>(mL * difficulty));
-
-			Weapon result;
-
-			result.name = "Generated name TODO (lvl: " + ssvu::toStr(d) + ")";
-			result.atk = getRndStat(mL, 0.5f, 1.8f) + 1;
-			generateRndElements(mL, result.strongAgainst);
-			generateRndElements(mL, result.weakAgainst);
-			result.type = static_cast<Weapon::Type>(ssvu::getRnd(0, 3));
-
-			return result;
-		}
-
-		inline Armor generateArmor(int mL)
-		{
-			auto d(static_cast<int>(mL * difficulty));
-
-			Armor result;
-
-			result.name = "Generated name TODO (lvl: " + ssvu::toStr(d) + ")";
-			result.def = getRndStat(mL, 0.5f, 1.8f) * 0.7f;
-			generateRndElements(mL, result.elementTypes);
-
-			return result;
-		}
-
-		inline Creature generateCreature(int mL)
-		{
-			auto d(static_cast<int>(mL * difficulty));
-
-			Creature result;
-
-			result.name = getGen().generateCreatureName();
-			result.armor = generateArmor(ssvu::getClampedMin(mL * 0.69f + difficulty - 1, 1));
-			result.weapon = generateWeapon(mL - 1);
-			result.hps = d * 5 + ssvu::getRnd(0, d * 3);
-
-			return result;
-		}
-
-		inline ssvu::UPtr<Choice> generateChoiceCreature(int mIdx, int mL)
-		{
-			auto choice(ssvu::makeUPtr<ChoiceCreature>(*this, mIdx));
-			choice->creature = generateCreature((mL + difficulty + (roomNumber / 10)) * difficulty);
-			return std::move(choice);
-		}
-
-		inline ssvu::UPtr<Choice> generateChoiceSingleDrop(int mIdx, int mL)
-		{
-			auto choice(ssvu::makeUPtr<ChoiceSingleDrop>(*this, mIdx));
-			choice->drop = generateRndDrop(mL);
-			return std::move(choice);
-		}
-
-		inline ssvu::UPtr<Choice> generateChoiceMultipleDrop(int mIdx, int mL)
-		{
-			auto choice(ssvu::makeUPtr<ChoiceItemDrop>(*this, mIdx));
-			choice->itemDrops = generateDrops(mL);
-			return std::move(choice);
-		}
-
-		inline void generateChoices()
-		{
-			auto choiceNumber(2);
-
-			if(roomNumber > 10) choiceNumber = 3;
-			else if(roomNumber > 20) choiceNumber = 4;
-
-			auto indices(mkShuffledVector<int>(0, 1, 2, 3));
-			for(auto& c : choices) c.release();
+	class GameApp : public Boilerplate::App
+	{
+		private:
+			ssvs::BitmapText txtTimer{mkTxtOBBig()}, txtRoom{mkTxtOBBig()}, txtDeath{mkTxtOBBig()},
+							txtLog{mkTxtOBSmall()}, txtRestart{mkTxtOBSmall()}, txtMode{mkTxtOBSmall()};
+			std::uint64_t logGeneration{0};
+			int shownTimer{-2}, shownRoom{-1};
+			int shownDeathAlpha{-1};
+			bool deathTextDirty{true};
 
-			for(int i{0}; i < choiceNumber; ++i)
+			// Session state the cached layers depend on: any change re-renders them
+			struct LayerKey
 			{
-				auto idx(indices[i]);
+				GameSession::State state{GameSession::State::Menu};
+				GameSession::Mode mode{GameSession::Mode::Official};
+				int roomNumber{-1};
+				const void* drops{nullptr};
+				unsigned int dropMask{0};
+				std::array<const void*, Constants::maxChoices> choices{{}};
+				bool gameplayReady{false};
+
+				inline auto getTie() const noexcept { return std::tie(state, mode, roomNumber, drops, dropMask, choices, gameplayReady); }
+				inline bool operator==(const LayerKey& mX) const noexcept { return getTie() == mX.getTie(); }
+				inline bool operator!=(const LayerKey& mX) const noexcept { return !(*this == mX); }
+			};
+
+			LayerKey layerKey;
+			Boilerplate::RenderLayer roomLayer, menuLayer;
+			Boilerplate::SpriteBatch spriteBatch{getAssets().atlas};
+			ssvs::BitmapText txtRenderStats{mkTxtOBSmall()};
+			bool showRenderStats{false};
+
+			Boilerplate::InputLatency inputLatency;
+			bool choiceKeysDown[4]{};	// Held keys repeat `KeyPressed` events: a choice runs once per press
+			std::uint64_t lastCommandSeq{0}, latencySeq{0};
+
+			// Hover animations and camera shake, drawn from the view: the session's own streams stay on its thread
+			Rng cosmeticRng;
+
+#if defined(GGJ2015_PROFILER)
+			ProfilerOverlay profilerOverlay;
+			bool showProfiler{false};
+#endif
+
+			// Views built from the gameplay asset groups, created once those are resident
+			struct PlayingView
+			{
+				std::vector<SlotChoice> slotChoices;
+				sf::Sprite dropsModalSprite;
+				CreatureStatsDraw csdPlayer;
 
-				if(ssvu::getRnd(0, 100) > 15)
+				inline PlayingView()
 				{
-					choices[idx] = generateChoiceCreature(idx, roomNumber);
-				}
-				else
-				{
-					if(ssvu::getRnd(0, 100) > 20)
-					{
-						choices[idx] = generateChoiceSingleDrop(idx, roomNumber);
-					}
-					else
-					{
-						choices[idx] = generateChoiceMultipleDrop(idx, roomNumber);
-					}
-				}
-			}
-		}
-
-		inline void refreshMusic()
-		{
-			music.setLoop(true);
-			if(music.getBuffer() != currentMusic) music.setBuffer(*currentMusic);
-			if(music.getStatus() != sf::Sound::Status::Playing) music.play();
-		}
+					for(int i{0}; i < 4; ++i) slotChoices.emplace_back(i);
 
-		template<typename T> inline void resetChoiceAt(SizeT mIdx, T&& mX)
-		{
-			nextChoices[mIdx] = ssvu::fwd<T>(mX);
-		}
+					dropsModalSprite.setTexture(*getAssets().dropsModal);
+					dropsModalSprite.setPosition(10, 40);
+				}
+			};
 
-		inline void advance()
-		{
-			++roomNumber;
+			ssvs::BitmapTextRich txtCredits{*getAssets().fontObStroked};
+			UPtr<PlayingView> playingView;
+			Vec2f oldPos;
 
-			if(roomNumber < 10)			currentMusic = getAssets().lvl1;
-			else if(roomNumber < 20)	currentMusic = getAssets().lvl2;
-			else if(roomNumber < 30)	currentMusic = getAssets().lvl3;
-			else if(roomNumber < 40)	currentMusic = getAssets().lvl4;
+			// Declared last: its thread is stopped before anything else is destroyed
+			Simulation sim;
 
-			refreshMusic();
+			inline const auto& getSessionView() const noexcept { return sim.getView().session; }
 
-			if(roomNumber % 5 == 0)
+			/// @brief Sends a command to the session, returning its sequence number (0 if it was dropped).
+			inline std::uint64_t send(Simulation::Command::Type mType, int mKey = 0)
 			{
-				eventLo() << "Increasing difficulty...\n";
-				difficulty += difficultyInc;
+				if(!sim.send(Simulation::Command{mType, mKey, lastCommandSeq + 1})) return 0;
+				return ++lastCommandSeq;
 			}
 
-			generateChoices();
-			resetTimer();
-			endDrops();
-		}
-
-		inline void die()
-		{
-			music.stop();
-			getAssets().soundPlayer.play(*getAssets().lose);
-			shake = 250;
-			deathTextTime = 255;
-			state = GameSession::State::Dead;
-		}
-	};
-
-	inline void ChoiceAdvance::execute()
-	{
-		gameSession.advance();
-	}
-	inline void ChoiceAdvance::draw(ssvs::GameWindow& mGW, const Vec2f&, const Vec2f& mCenter)
-	{
-		advanceSprite.setPosition(mCenter);
-		mGW.draw(advanceSprite);
-	}
-
-	inline ChoiceItemDrop::ChoiceItemDrop(GameSession& mGS, SizeT mIdx) : Choice{mGS, mIdx}
-	{
-		drops.setTexture(*getAssets().drops);
-		itemDrops = mGS.generateDrops(mGS.roomNumber);
-	}
-	inline void ChoiceItemDrop::execute()
-	{
-		getAssets().soundPlayer.play(*getAssets().grab);
-		gameSession.startDrops(&itemDrops);
-		gameSession.resetChoiceAt(idx, ssvu::makeUPtr<ChoiceAdvance>(gameSession, idx));
-	}
-	inline void ChoiceItemDrop::draw(ssvs::GameWindow& mGW, const Vec2f& mPos, const Vec2f&)
-	{
-		drops.setPosition(mPos);
-		mGW.draw(drops);
-	}
-
-	inline ChoiceSingleDrop::ChoiceSingleDrop(GameSession& mGS, SizeT mIdx) : Choice{mGS, mIdx}
-	{
-
-	}
-	inline void ChoiceSingleDrop::execute()
-	{
-		if(drop == nullptr) return;
-
-		drop->apply(gameSession.player);
-		gameSession.resetChoiceAt(idx, ssvu::makeUPtr<ChoiceAdvance>(gameSession, idx));
-	}
-	inline void ChoiceSingleDrop::draw(ssvs::GameWindow& mGW, const Vec2f& mPos, const Vec2f& mCenter)
-	{
-		if(drop == nullptr) return;
-
-		drop->draw(mGW, mPos, mCenter);
-	}
-
-
-	inline void ChoiceCreature::execute()
-	{
-		gameSession.player.weapon.playAttackSounds();
-
-		if(gameSession.player.canDamage(creature))
-		{
-			gameSession.player.fight(creature);
-
-			gameSession.sustain();
-
-			getAssets().soundPlayer.play(*getAssets().drop);
-			gameSession.resetChoiceAt(idx, ssvu::makeUPtr<ChoiceItemDrop>(gameSession, idx));
-
-			gameSession.shake = 10;
-		}
-		else
-		{
-			eventLo() << gameSession.player.name << " cannot fight " << creature.name << "!\n";
-		}
-	}
-	inline void ChoiceCreature::draw(ssvs::GameWindow& mGW, const Vec2f& mPos, const Vec2f& mCenter)
-	{
-		Vec2f offset{4.f, 4.f};
-		hoverRads = ssvu::wrapRad(hoverRads + 0.05f);
-		enemySprite.setPosition(mCenter + Vec2f(0, std::sin(hoverRads) * 4.f));
-		mGW.draw(enemySprite);
-		csd.draw(creature, mGW, offset + mPos, mCenter);
-	}
-
-	inline void InstantEffect::apply(GameSession& mGameSession, Creature& mX)
-	{
-		StatType* statPtr{nullptr};
-
-		switch(stat)
-		{
-			case Stat::SHPS: statPtr = &mX.hps; break;
-			case Stat::SATK: statPtr = &mX.bonusATK; break;
-			case Stat::SDEF: statPtr = &mX.bonusDEF; break;
-		}
-
-		float x(static_cast<float>(*statPtr));
-
-		switch(type)
-		{
-			case Type::Add: *statPtr += value; break;
-			case Type::Sub: *statPtr -= value; break;
-			case Type::Mul: *statPtr = static_cast<int>(x * value); break;
-			case Type::Div: *statPtr = static_cast<int>(x / value); break;
-		}
-
-		eventLo() << "Got " << getStrType() << ssvu::toStr(static_cast<int>(value)) << " " << getStrStat() << "!\n";
-
-		mX.checkBurns(mGameSession);
-	}
-
-	inline void Creature::checkBurns(GameSession& mGameSession)
-	{
-		int burn{0};
-
-		if(bonusATK < 0)
-		{
-			burn -= bonusATK;
-			bonusATK = 0;
-		}
-
-		if(bonusDEF < 0)
-		{
-			burn -= bonusDEF;
-			bonusDEF = 0;
-		}
-
-		if(burn == 0) return;
-
-		auto x(burn * (4 * mGameSession.roomNumber * mGameSession.difficulty));
-
-		hps -= x;
-		eventLo() << name << " suffers " << x << " stat burn dmg!\n";
-	}
-
-	struct SlotChoice
-	{
-		sf::RectangleShape shape;
-		sf::Sprite sprite;
-		ssvs::BitmapText txtNum;
-		ssvs::BitmapText txtStr;
-		int choice;
-
-		static constexpr float step{300.f / 4.f};
-
-		inline SlotChoice(int mChoice) : txtNum{*getAssets().fontObBig, ssvu::toStr(mChoice + 1)},
-			txtStr{mkTxtOBSmall()}, choice{mChoice}
-		{
-			shape.setSize(Vec2f{step, 130.f});
-			shape.setFillColor(sf::Color::Red);
-			shape.setPosition(Vec2f{10 + step * mChoice, 40});
-
-			sprite.setTexture(*getAssets().slotChoice);
-			sprite.setPosition(Vec2f{10 + step * mChoice, 40});
-
-			ssvs::setOrigin(txtNum, ssvs::getLocalCenter);
-			txtNum.setPosition(Vec2f{10 + step * mChoice + (step / 2.f), 40 + 105});
-		}
-
-		inline void update()
-		{
-			ssvs::setOrigin(txtStr, ssvs::getLocalCenter);
-			txtStr.setPosition(Vec2f{10 + step * choice + (step / 2.f), 40 + 120});
-		}
-
-		inline Vec2f getCenter()
-		{
-			return Vec2f{10 + (step * choice) + (step / 2.f), 40 + 130.f / 2.f};
-		}
-
-		inline void drawInCenter(ssvs::GameWindow& mGW, const sf::Texture& mX)
-		{
-			sf::Sprite s;
-			s.setTexture(mX);
-			ssvs::setOrigin(s, ssvs::getLocalCenter);
-			s.setPosition(getCenter());
-			mGW.draw(s);
-		}
-	};
-
-	class GameApp : public Boilerplate::App
-	{
-		private:
-			GameSession gs;
-			ssvs::BitmapText txtTimer{mkTxtOBBig()}, txtRoom{mkTxtOBBig()}, txtDeath{mkTxtOBBig()},
-							txtLog{mkTxtOBSmall()}, txtRestart{mkTxtOBSmall()}, txtMode{mkTxtOBSmall()};
-
-			ssvs::BitmapTextRich txtCredits{*getAssets().fontObStroked};
-			std::vector<SlotChoice> slotChoices;
-			sf::Sprite dropsModalSprite;
-			CreatureStatsDraw csdPlayer;
-			Vec2f oldPos;
-
 			inline void initInput()
 			{
 				auto& gState(gameState);
 
 				// TODO: better input management, choose handling type
-				gState.addInput({{IK::Escape}}, [this](FT){ if(gs.state != GameSession::State::Menu) gs.gotoMenu(); }, IT::Once);
+				gState.addInput({{IK::Escape}}, [this](FT){ send(Simulation::Command::Type::Menu); }, IT::Once);
 
 				gState.addInput({{IK::A}}, [this](FT){ gameCamera.pan(-4, 0); });
 				gState.addInput({{IK::D}}, [this](FT){ gameCamera.pan(4, 0); });
@@ -1470,147 +1058,101 @@ namespace ggj
 				gState.addInput({{IK::Q}}, [this](FT){ gameCamera.zoomOut(1.1f); });
 				gState.addInput({{IK::E}}, [this](FT){ gameCamera.zoomIn(1.1f); });
 
-				gState.addInput({{IK::Num1}}, [this](FT){ executeChoice(0); }, IT::Once);
-				gState.addInput({{IK::Num2}}, [this](FT){ executeChoice(1); }, IT::Once);
-				gState.addInput({{IK::Num3}}, [this](FT){ executeChoice(2); }, IT::Once);
-				gState.addInput({{IK::Num4}}, [this](FT){ executeChoice(3); }, IT::Once);
+				// Choice keys are sent from the event stream as they arrive, instead of being polled by
+				// the next update step: the session handles them as soon as its thread wakes up.
+				gState.onEvent(sf::Event::KeyPressed) += [this](const sf::Event& mE){ onChoiceKey(mE.key.code, true); };
+				gState.onEvent(sf::Event::KeyReleased) += [this](const sf::Event& mE){ onChoiceKey(mE.key.code, false); };
+				gState.onEvent(sf::Event::LostFocus) += [this](const sf::Event&){ for(auto& k : choiceKeysDown) k = false; };
+
+				gState.addInput({{IK::F3}}, [this](FT){ showRenderStats = !showRenderStats; }, IT::Once);
+
+#if defined(GGJ2015_PROFILER)
+				gState.addInput({{IK::F4}}, [this](FT){ showProfiler = !showProfiler; }, IT::Once);
+				gState.addInput({{IK::F5}}, [this](FT)
+				{
+					std::ofstream o{"profile.csv"};
+					Profiler::getProfiler().dumpCSV(o);
+					ssvu::lo("Profiler") << "Dumped " << Profiler::getProfiler().getFrameCount() << " frames to profile.csv\n";
+				}, IT::Once);
+#endif
 			}
 
-			inline void executeChoice(int mI)
+			inline void onChoiceKey(sf::Keyboard::Key mKey, bool mPressed)
 			{
-				if(gs.state == GameSession::State::Menu)
-				{
-					if(mI == 0)
-					{
-						gs.mode = GameSession::Mode::Beginner;
-						gs.restart();
-					}
+				auto time(Boilerplate::InputLatency::Clock::now());
 
-					if(mI == 1)
-					{
-						gs.mode = GameSession::Mode::Official;
-						gs.restart();
-					}
+				auto idx(static_cast<int>(mKey) - static_cast<int>(IK::Num1));
+				if(idx < 0 || idx > 3 || choiceKeysDown[idx] == mPressed) return;
 
-					if(mI == 2)
-					{
-						gs.mode = GameSession::Mode::Hardcore;
-						gs.restart();
-					}
+				choiceKeysDown[idx] = mPressed;
+				if(!mPressed) return;
 
-					if(mI == 3)
-					{
-						stop();
-					}
+				auto seq(send(Simulation::Command::Type::Choice, idx));
+				if(seq != 0 && inputLatency.onPress(time)) latencySeq = seq;
+			}
 
-					return;
-				}
+			inline void update(FT mFT)
+			{
+				GGJ_PROFILE_SCOPE(Update);
 
-				if(gs.state == GameSession::State::Dead)
+				getAssets().assetLoader.update();
+				if(playingView == nullptr && getAssets().isGameplayResident())
 				{
-					if(mI == 0) gs.gotoMenu();
-					else if(mI == 1) gs.restart();
-
-					return;
+					playingView = ssvu::makeUPtr<PlayingView>();
+					sim.setGameplayReady();
 				}
 
-				if(gs.currentDrops == nullptr)
-				{
-					if(gs.choices[mI] == nullptr) return;
+				if(sim.isQuitRequested()) stop();
 
-					gs.choices[mI]->execute();
+				gameCamera.update<float>(mFT);
 
-					if(gs.currentDrops == nullptr)
-						gs.refreshChoices();
+				const auto& sv(getSessionView());
+				if(sv.shake > 0)
+				{
+					auto shake(std::abs(sv.shake));
+					gameCamera.setCenter(oldPos + Vec2f{cosmeticRng.getRndR(-shake, shake + 0.1f), cosmeticRng.getRndR(-shake, shake + 0.1f)});
 				}
 				else
 				{
-					if(mI == 0)
-					{
-						gs.endDrops();
-						gs.refreshChoices();
-					}
-					else
-					{
-						gs.tryPickupDrop(mI - 1);
-					}
+					gameCamera.setCenter(oldPos);
 				}
 			}
 
-			inline void update(FT mFT)
+			// Texts are only rebuilt when the shown value changes
+			inline void refreshTexts(const SessionView& mSV)
 			{
-				gameCamera.update<float>(mFT);
-
-				if(gs.deathTextTime > 0) gs.deathTextTime -= mFT;
+				auto intt(ssvu::getFTToSeconds(static_cast<int>(mSV.timer)));
+				auto third(gameWindow.getWidth() / 5.f);
 
-				if(gs.state == GameSession::State::Playing)
+				auto timerKey(mSV.timerEnabled ? intt : -1);
+				if(timerKey != shownTimer)
 				{
-					if(gs.timerEnabled) gs.timer -= mFT;
-
-					if(!gs.player.isDead())
-					{
-						auto secs(ssvu::getFTToSeconds(gs.timer));
-						if(secs < 3) ssvu::clampMin(gs.shake, 4 - secs);
-					}
-
-					if(gs.timer <= 0 || gs.player.isDead())
-					{
-						gs.die();
-					}
-					else
-					{
-						auto intt(ssvu::getFTToSeconds(static_cast<int>(gs.timer)));
-						auto gts(intt >= 10 ? ssvu::toStr(intt) : "0" + ssvu::toStr(intt));
-
-						auto third(gameWindow.getWidth() / 5.f);
-
-						txtTimer.setString(gs.timerEnabled ? "00:" + gts : "XX:XX");
-
-						ssvs::setOrigin(txtTimer, ssvs::getLocalCenter);
-						txtTimer.setPosition(third * 1.f, 20);
-
-						txtRoom.setString("Room:" + ssvu::toStr(gs.roomNumber));
-						ssvs::setOrigin(txtRoom, ssvs::getLocalCenter);
-						txtRoom.setPosition(third * 4.f, 20);
-
-						// TODO: wtf
-						auto els(getEventLogStream().str());
-						if(!els.empty())
-						{
-							std::string elsLog;
-
-							int foundNewLines{0};
+					shownTimer = timerKey;
 
-							for(auto itr(els.rbegin()); itr < els.rend(); ++itr)
-							{
-								if(*itr == '\n') ++foundNewLines;
-								if(foundNewLines == 6) break;
-								elsLog += *itr;
-							}
+					auto gts(intt >= 10 ? ssvu::toStr(intt) : "0" + ssvu::toStr(intt));
+					txtTimer.setString(mSV.timerEnabled ? "00:" + gts : "XX:XX");
 
-							std::string final{elsLog.rbegin(), elsLog.rend()};
-							txtLog.setString(final);
-						}
-					}
+					ssvs::setOrigin(txtTimer, ssvs::getLocalCenter);
+					txtTimer.setPosition(third * 1.f, 20);
 				}
-				else if(gs.state == GameSession::State::Menu)
+
+				if(mSV.roomNumber != shownRoom)
 				{
+					shownRoom = mSV.roomNumber;
 
+					txtRoom.setString("Room:" + ssvu::toStr(mSV.roomNumber));
+					ssvs::setOrigin(txtRoom, ssvs::getLocalCenter);
+					txtRoom.setPosition(third * 4.f, 20);
 				}
 
-				if(gs.shake > 0)
+				if(mSV.logGeneration != logGeneration)
 				{
-					gs.shake -= mFT;
-					auto shake(std::abs(gs.shake));
-					gameCamera.setCenter(oldPos + Vec2f{ssvu::getRndR(-shake, shake + 0.1f), ssvu::getRndR(-shake, shake + 0.1f)});
-				}
-				else
-				{
-					gameCamera.setCenter(oldPos);
+					logGeneration = mSV.logGeneration;
+					txtLog.setString(std::string(mSV.log, mSV.logSize));
 				}
 			}
 
-			inline const auto& getModeStr()
+			inline static const auto& getModeStr(GameSession::Mode mX)
 			{
 				static auto array(ssvu::makeArray
 				(
@@ -1619,22 +1161,56 @@ namespace ggj
 					"Hardcore mode"
 				));
 
-				return array[static_cast<int>(gs.mode)];
+				return array[static_cast<int>(mX)];
 			}
 
-			inline void drawPlaying()
+			inline auto getLayerKey(const SessionView& mSV) const noexcept
 			{
-				txtMode.setString(getModeStr());
+				LayerKey result;
+
+				result.state = mSV.state;
+				result.mode = mSV.mode;
+				result.roomNumber = mSV.roomNumber;
+				result.drops = mSV.dropsID;
+
+				if(mSV.dropsID != nullptr)
+					for(auto i(0u); i < Constants::maxDrops; ++i)
+						if(mSV.hasDrop[i]) result.dropMask |= 1u << i;
+
+				for(auto i(0u); i < Constants::maxChoices; ++i) result.choices[i] = mSV.hasChoice[i] ? mSV.choices[i].id : nullptr;
+
+				result.gameplayReady = playingView != nullptr;
+
+				return result;
+			}
+
+			inline void refreshLayers(const SessionView& mSV)
+			{
+				auto key(getLayerKey(mSV));
+				if(key == layerKey) return;
+
+				layerKey = key;
+				roomLayer.invalidate();
+				menuLayer.invalidate();
+				deathTextDirty = true;
+				shownDeathAlpha = -1;
+			}
+
+			// Room layer: everything in the playing view that only changes with the room, the choices or the drops modal
+			inline void drawRoomLayer(sf::RenderTarget& mRT, const SessionView& mSV)
+			{
+				auto& slotChoices(playingView->slotChoices);
+
+				txtMode.setString(getModeStr(mSV.mode));
 				ssvs::setOrigin(txtMode, ssvs::getLocalCenterS);
 				txtMode.setPosition(320 / 2.f, 40 - 2);
 
-				render(txtTimer);
-				render(txtRoom);
-				render(txtMode);
+				Boilerplate::draw(mRT, txtRoom);
+				Boilerplate::draw(mRT, txtMode);
 
-				if(gs.currentDrops != nullptr)
+				if(mSV.dropsID != nullptr)
 				{
-					render(dropsModalSprite);
+					Boilerplate::draw(mRT, playingView->dropsModalSprite);
 
 					for(auto i(0u); i < slotChoices.size(); ++i)
 					{
@@ -1642,21 +1218,12 @@ namespace ggj
 
 						if(i == 0)
 						{
-							sc.drawInCenter(gameWindow, *getAssets().back);
-							sc.txtStr.setString("Back");
+							sc.drawInCenter(mRT, *getAssets().back);
+							sc.drawLabels(mRT, "Back");
 						}
-						else if(gs.currentDrops->has(i - 1))
+						else if(mSV.hasDrop[i - 1])
 						{
-							gs.currentDrops->drops[i -1]->draw(gameWindow, sc.shape.getPosition(), sc.getCenter());
-							sc.txtStr.setString("Pickup");
-						}
-
-						sc.update();
-
-						if(i == 0 || gs.currentDrops->has(i - 1))
-						{
-							render(sc.txtNum);
-							render(sc.txtStr);
+							sc.drawLabels(mRT, "Pickup");
 						}
 					}
 				}
@@ -1665,89 +1232,157 @@ namespace ggj
 					for(auto i(0u); i < slotChoices.size(); ++i)
 					{
 						auto& sc(slotChoices[i]);
-						const auto& gc(gs.choices[i]);
+						auto has(mSV.hasChoice[i]);
 
-						sc.txtStr.setString(gc == nullptr ? "Blocked" : gc->getChoiceStr());
-						sc.update();
+						Boilerplate::draw(mRT, sc.shape);
+						Boilerplate::draw(mRT, sc.sprite);
 
-						render(sc.shape);
-						render(sc.sprite);
+						if(!has) sc.drawInCenter(mRT, *getAssets().blocked);
 
-						if(gc != nullptr)
-						{
-							gc->draw(gameWindow, sc.shape.getPosition(), sc.getCenter());
-						}
-						else
-						{
-							sc.drawInCenter(gameWindow, *getAssets().blocked);
-						}
+						sc.drawLabels(mRT, has ? getChoiceLabel(mSV.choices[i].type) : "Blocked");
+					}
+				}
+			}
+
+			inline void drawMenuLayer(sf::RenderTarget& mRT)
+			{
+				txtDeath.setString("DELVER'S CHOICE");
+				txtDeath.setColor(sf::Color(255, 255, 255, 255));
+
+				if(playingView != nullptr)
+					txtRestart.setString("1. Beginner mode\n"
+										 "2. Official mode\n"
+										 "3. Hardcore mode\n"
+										 "4. Exit game");
+				else
+					txtRestart.setString("Loading...\n\n\n"
+										 "4. Exit game");
+
+				txtRestart.setColor(sf::Color(255, 255, 255, 255));
 
-						render(sc.txtNum);
-						render(sc.txtStr);
+				ssvs::setOrigin(txtDeath, ssvs::getLocalCenter);
+				ssvs::setOrigin(txtRestart, ssvs::getLocalCenter);
+
+				txtDeath.setPosition(320 / 2.f, 30);
+				txtRestart.setPosition(320 / 2.f, 70);
+
+				Boilerplate::draw(mRT, txtDeath);
+				Boilerplate::draw(mRT, txtRestart);
+				Boilerplate::draw(mRT, txtCredits);
+			}
+
+			inline void drawPlaying(const SessionView& mSV)
+			{
+				GGJ_PROFILE_SCOPE(DrawPlaying);
+
+				auto& slotChoices(playingView->slotChoices);
+
+				render(txtTimer);
+
+				roomLayer.draw(gameWindow, [this, &mSV](sf::RenderTarget& mRT){ drawRoomLayer(mRT, mSV); });
+
+				// Dynamic parts: creature hover animations, cards and stats. Their sprites are
+				// batched into one draw, with the text on top.
+				spriteBatch.begin(gameWindow);
+
+				if(mSV.dropsID != nullptr)
+				{
+					for(auto i(1u); i < slotChoices.size(); ++i)
+					{
+						auto& sc(slotChoices[i]);
+						if(mSV.hasDrop[i - 1]) sc.dropDraw.draw(mSV.drops[i - 1], gameWindow, sc.shape.getPosition(), sc.getCenter());
 					}
 				}
+				else
+				{
+					for(auto i(0u); i < slotChoices.size(); ++i)
+						if(mSV.hasChoice[i]) slotChoices[i].drawChoice(mSV.choices[i], gameWindow, cosmeticRng);
+				}
 
 				render(txtLog);
 
-				csdPlayer.draw(gs.player, gameWindow, Vec2f{10, 175}, Vec2f{0.f, 0.f});
+				playingView->csdPlayer.draw(mSV.player, gameWindow, Vec2f{10, 175}, Vec2f{0.f, 0.f});
+
+				spriteBatch.end(gameWindow);
 			}
 
 			inline void draw()
 			{
-				gameCamera.apply();
+				inputLatency.beginFrame();
+				getAssets().assetLoader.onFrame();
+				Boilerplate::getRenderStats().beginFrame();
 
-				if(gs.state == GameSession::State::Playing || gs.deathTextTime > 0)
-					drawPlaying();
+				// The whole frame is drawn from the latest view published by the session's thread
+				sim.updateView();
+				const auto& view(sim.getView());
+				const auto& sv(view.session);
 
-				gameCamera.unapply();
+				if(sv.state == GameSession::State::Playing) refreshTexts(sv);
+				refreshLayers(sv);
 
-				ssvs::setOrigin(txtDeath, ssvs::getLocalCenter);
-				ssvs::setOrigin(txtRestart, ssvs::getLocalCenter);
-				ssvs::setOrigin(txtCredits, ssvs::getLocalSW);
+				gameCamera.apply();
 
-				txtCredits.setPosition(5, 240 - 5);
+				if(sv.state == GameSession::State::Playing || sv.deathTextTime > 0)
+					drawPlaying(sv);
 
-				if(gs.state == GameSession::State::Dead)
-				{
-					txtDeath.setString("You have perished.");
-					txtRestart.setString("Press 1 for menu.\n"
-										 "Press 2 to restart.\n\n"
-										 "You reached room " + ssvu::toStr(gs.roomNumber) + ".\n"
-										 "(" + getModeStr() + ")");
+				gameCamera.unapply();
 
-					txtDeath.setPosition(320 / 2.f, 80);
-					txtRestart.setPosition(320 / 2.f, 120);
+				if(sv.state == GameSession::State::Dead)
+				{
+					if(deathTextDirty)
+					{
+						deathTextDirty = false;
+
+						txtDeath.setString("You have perished.");
+						txtRestart.setString("Press 1 for menu.\n"
+											 "Press 2 to restart.\n\n"
+											 "You reached room " + ssvu::toStr(sv.roomNumber) + ".\n"
+											 "(" + getModeStr(sv.mode) + ")");
+
+						ssvs::setOrigin(txtDeath, ssvs::getLocalCenter);
+						ssvs::setOrigin(txtRestart, ssvs::getLocalCenter);
+						txtDeath.setPosition(320 / 2.f, 80);
+						txtRestart.setPosition(320 / 2.f, 120);
+					}
 
 					render(txtDeath);
 					render(txtRestart);
 
-					txtDeath.setColor(sf::Color(255, 255, 255, 255 - static_cast<unsigned char>(gs.deathTextTime)));
-					txtRestart.setColor(sf::Color(255, 255, 255, 255 - static_cast<unsigned char>(gs.deathTextTime)));
+					auto alpha(255 - static_cast<unsigned char>(sv.deathTextTime));
+					if(alpha != shownDeathAlpha)
+					{
+						shownDeathAlpha = alpha;
+						txtDeath.setColor(sf::Color(255, 255, 255, alpha));
+						txtRestart.setColor(sf::Color(255, 255, 255, alpha));
+					}
 				}
 
-				if(gs.state == GameSession::State::Menu)
-				{
-					txtDeath.setString("DELVER'S CHOICE");
-					txtDeath.setColor(sf::Color(255, 255, 255, 255));
-
-					txtDeath.setPosition(320 / 2.f, 30);
-					txtRestart.setPosition(320 / 2.f, 70);
+				if(sv.state == GameSession::State::Menu)
+					menuLayer.draw(gameWindow, [this](sf::RenderTarget& mRT){ drawMenuLayer(mRT); });
 
-					txtRestart.setString("1. Beginner mode\n"
-										 "2. Official mode\n"
-										 "3. Hardcore mode\n"
-										 "4. Exit game");
+				// Not counted, so that the overlay does not change the numbers it shows
+				if(showRenderStats)
+				{
+					const auto& rs(Boilerplate::getRenderStats());
+					txtRenderStats.setString("Draws: " + ssvu::toStr(rs.drawCalls) + "\nBinds: " + ssvu::toStr(rs.textureBinds)
+						+ "\nVoices: " + ssvu::toStr(view.activeVoices) + "/" + ssvu::toStr(VoicePool::voiceCount)
+						+ "\nDropped: " + ssvu::toStr(view.droppedVoices) + "\nStolen: " + ssvu::toStr(view.stolenVoices)
+						+ "\nLatency: " + getMsStr(inputLatency.getLastMs()) + "\n avg " + getMsStr(inputLatency.getMeanMs())
+						+ "\n max " + getMsStr(inputLatency.getMaxMs()));
+					gameWindow.draw(txtRenderStats);
+				}
 
-					txtRestart.setColor(sf::Color(255, 255, 255, 255));
+#if defined(GGJ2015_PROFILER)
+				if(showProfiler) profilerOverlay.draw(gameWindow);
+				Profiler::getProfiler().endFrame();
+#endif
 
-					render(txtDeath);
-					render(txtRestart);
-					render(txtCredits);
-				}
+				inputLatency.endFrame(view.commandsHandled >= latencySeq);
 			}
 
 		public:
-			inline GameApp(ssvs::GameWindow& mGameWindow) : Boilerplate::App{mGameWindow}
+			inline GameApp(ssvs::GameWindow& mGameWindow, const Boilerplate::LoopConfig& mLoop, const std::string& mReplayPath)
+				: Boilerplate::App{mGameWindow}, sim{mLoop, mReplayPath}
 			{
 				using sfc = sf::Color;
 
@@ -1763,29 +1398,52 @@ namespace ggj
 					<< sfc::Blue << "http://vittorioromeo.info\nhttp://nicolabombaci.com";
 
 
-				for(int i{0}; i < 4; ++i) slotChoices.emplace_back(i);
-
 				gameState.onUpdate += [this](FT mFT){ update(mFT); };
 				gameState.onDraw += [this]{ draw(); };
 
-				dropsModalSprite.setTexture(*getAssets().dropsModal);
-				dropsModalSprite.setPosition(10, 40);
-
 				txtLog.setPosition(Vec2f{75, 180});
 
+				ssvs::setOrigin(txtCredits, ssvs::getLocalSW);
+				txtCredits.setPosition(5, 240 - 5);
+				txtRenderStats.setPosition(Vec2f{250, 2});
+
+				roomLayer.create(320, 240);
+				menuLayer.create(320, 240);
+
 				initInput();
 
 				oldPos = gameCamera.getCenter();
-
-				gs.gotoMenu();
 			}
 	};
 }
 
-int main()
+// Usage: GGJ2015 [options]
+// Options: --replay file      plays a recorded run back at real speed
+//          --timestep ft      simulated time per session step, in 1/60 s (default 0.5)
+//          --max-catch-up n   steps run at most at once after a stall (default 8)
+//          --vsync            paces frames on the display instead of the frame rate limit
+//          --max-fps n        frame rate limit without vsync, 0 for none (default 200)
+int main(int argc, char* argv[])
 {
 	SSVUT_RUN();
 
-	Boilerplate::AppRunner<ggj::GameApp>{"Delver's choice - GGJ2015 - RC6", 320, 240};
+	std::string replayPath;
+	Boilerplate::LoopConfig loop;
+
+	for(auto i(1); i < argc; ++i)
+	{
+		std::string arg{argv[i]};
+
+		if(arg == "--vsync") loop.vsync = true;
+		else if(i + 1 < argc)
+		{
+			if(arg == "--replay") replayPath = argv[++i];
+			else if(arg == "--timestep") loop.timestep = ssvu::getClampedMin(std::stof(argv[++i]), 0.05f);
+			else if(arg == "--max-catch-up") loop.maxCatchUp = ssvu::getClampedMin(std::stof(argv[++i]), 1.f);
+			else if(arg == "--max-fps") loop.maxFPS = std::stof(argv[++i]);
+		}
+	}
+
+	Boilerplate::AppRunner<ggj::GameApp>{"Delver's choice - GGJ2015 - RC6", 320, 240, loop, replayPath};
 	return 0;
 }